@@ -4,14 +4,39 @@
 #pragma once
 
 #include <iostream>
+#include <map>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
 
-// Note: Event help is not dependent on any other classes in this project
+// Note: Event help is only dependent on funcHelper (and InplaceFunc)
 #include "include/Utils/EventHelper.hpp"
+// only used for timing the benchmarks
+#include "include/Utils/Stopwatch.hpp"
 
 class EventHelperTest
 {
 public:
     static void test();
+    /// @brief prints the time it takes to invoke events with different numbers of callbacks
+    static void benchmark();
+    /// @brief prints the latency of adding synchronized events from multiple threads and how fast they are called
+    static void synchronizedBenchmark();
+    /// @brief prints the time it takes to invoke dynamic funcs and events compared to calling the function directly
+    static void dynamicBenchmark();
+    /// @brief prints the time it takes to destroy events while other threads are adding to the synchronized queue
+    static void teardownBenchmark();
+    /// @brief destroys events while another thread is updating the queue they where invoked with and prints if any call used a destroyed event
+    static void teardownCheck();
+    /// @brief prints the speedup of invoking events in parallel for different numbers of callbacks and amounts of work
+    static void parallelBenchmark();
+    /// @brief prints the time it takes to deliver many payloads with a batched event compared to invoking once per payload
+    static void batchBenchmark();
 
 private:
     inline EventHelperTest() = default;
@@ -9,6 +9,16 @@ class LogTest
 {
 public:
     static void test();
+    /// @brief prints the latency percentiles of adding logs synchronously and asynchronously
+    static void benchmark();
+    /// @brief prints how many logs per second can be added from different numbers of threads and checks that no lines where mixed
+    static void threadedBenchmark();
+    /// @brief prints the time and space used by binary logs compared to text logs
+    static void binaryBenchmark();
+    /// @brief prints how long the first log takes with many old logs in the folder and checks that rotation keeps the folder under its limit
+    static void rotationBenchmark();
+    /// @brief prints the cost of disabled and enabled logs through the LOG macros and how many logs get through a rate limit
+    static void levelBenchmark();
 
 private: 
     inline LogTest() = default;
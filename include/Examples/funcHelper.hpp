@@ -4,9 +4,17 @@
 #pragma once
 
 #include <iostream>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <atomic>
 
 // Note: funcHelper is not dependent on any other class contained in this project
 #include "include/Utils/funcHelper.hpp"
+// only used to show that events use the same allocation free storage
+#include "include/Utils/EventHelper.hpp"
 
 class testingClass
 {
@@ -31,6 +39,15 @@ class funcHelperTest
 {
 public:
     static void test();
+    /// @brief compares invoking dynamic funcs from multiple threads against the old global parameter storage
+    static void dynamicBenchmark();
+    /// @brief compares invoking funcs on the shared thread pool against starting a thread for each invoke
+    static void asyncBenchmark();
+
+    /// @brief number of times the global operator new has been called
+    /// @note only used to show that setting functions does not allocate
+    /// @note atomic since every thread of the program (thread pool workers, the async log writer, ...) allocates through the replaced operator new
+    static std::atomic<size_t> allocations;
 
 private:
     inline funcHelperTest() = default;
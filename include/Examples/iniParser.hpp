@@ -12,6 +12,12 @@ class iniParserTest
 {
 public:
     static void test();
+    /// @brief prints how long parsing generated files of 1MB, 100MB, 1GB, ... (up to the given size) takes
+    static void benchmark(size_t maxMegabytes = 100);
+    /// @brief prints how long looking up sections and keys by string_view, std::string, and const char* takes and how long reading typed values takes
+    static void lookupBenchmark(size_t lookups = 10000000);
+    /// @brief prints how long saving a file of the given size takes after small changes and how many writes the debounced autosave makes
+    static void saveBenchmark(size_t megabytes = 100);
 
 private: 
     inline iniParserTest() = default;
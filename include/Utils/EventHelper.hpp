@@ -4,13 +4,23 @@
 #pragma once
 
 // #include <unordered_map>
-#include <map>
-#include <list>
-#include <deque>
+#include <vector>
+#include <span>
+#include <tuple>
 #include <memory>
 #include <functional>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <cstdint>
 #include <cassert>
+#include <array>
+#include <algorithm>
+
+#include "InplaceFunc.hpp"
+#include "funcHelper.hpp"
+#include "ThreadPool.hpp"
 
 namespace EventHelper
 {
@@ -18,6 +28,558 @@ static constexpr size_t INVALID_ID = SIZE_MAX;
 static constexpr size_t STARTING_PUBLIC_ID = INVALID_ID-1;
 static constexpr size_t STARTING_PRIVATE_ID = 0;
 
+/// @brief if defined events record how often they are invoked and how long there callbacks take (see Event::getAllStats)
+/// @note must be defined the same for every file that includes this (i.e. as a compiler flag) since it changes the size of events
+/// @note when not defined none of the stats are recorded and the stats functions return nothing
+/// @note recording costs about one clock read per callback
+// #define EVENT_HELPER_STATS
+
+/// @brief number of buckets in the callback time histograms
+/// @note bucket i counts calls that took less than 2^(i+7) ns (128ns, 256ns, ...), the last bucket also counts every call that took longer
+static constexpr size_t STATS_HISTOGRAM_BUCKETS = 16;
+
+/// @brief the time spent in one callback of an event
+struct CallbackStats
+{
+    /// @brief the id returned when connecting the callback
+    size_t id = INVALID_ID;
+    uint64_t calls = 0;
+    /// @brief ns spent in this callback
+    uint64_t totalTime = 0;
+    /// @brief max ns one call took
+    uint64_t maxTime = 0;
+    std::array<uint64_t, STATS_HISTOGRAM_BUCKETS> histogram{};
+};
+
+/// @brief stats of an event since it was created or since its stats where reset
+struct EventStats
+{
+    /// @brief the name set with "setStatsName", empty if never set
+    std::string name;
+    /// @brief number of times the callbacks where called
+    uint64_t invokes = 0;
+    /// @brief number of callbacks that where connected the last time the event was invoked
+    size_t subscribers = 0;
+    /// @brief ns spent calling the callbacks of the event
+    uint64_t totalTime = 0;
+    /// @brief max ns one invoke took
+    uint64_t maxTime = 0;
+    /// @brief number of invokes that where called from a DispatchQueue (synchronized invokes)
+    uint64_t queuedCalls = 0;
+    /// @brief ns queued invokes waited in there queue before being called
+    uint64_t totalQueueWait = 0;
+    uint64_t maxQueueWait = 0;
+    /// @brief the callbacks that are still connected
+    std::vector<CallbackStats> callbacks;
+};
+
+/// @brief Contiguous storage for the callbacks of an event
+/// @note callbacks are kept in dense arrays and ids are mapped to their slot through a small hash table so connect, disconnect, and lookup are O(1)
+/// @note the memory used only depends on the number of connected callbacks, not on how many ids where given out
+/// @note private callbacks are stored in increasing id order and public callbacks in decreasing id order so iterating keeps the same order as the ids
+/// @note callbacks connected while iterating are staged and only added once the outer most iteration finishes (they are first called on the next invoke)
+/// @note removed callbacks are destroyed right away unless they are being called, then they are destroyed as soon as that call returns
+template <typename Callback>
+class CallbackStorage
+{
+public:
+    inline CallbackStorage() = default;
+
+    /// @brief adds the callback with the given id
+    /// @param isPrivate true if the id was created from the private counter
+    /// @note the id must be the newest id of its type
+    void insert(size_t id, bool isPrivate, Callback&& callback)
+    {
+        if (isPrivate)
+            m_private.insert(id, std::move(callback), m_iterating > 0);
+        else
+            m_public.insert(STARTING_PUBLIC_ID - id, std::move(callback), m_iterating > 0);
+    }
+
+    /// @returns pointer to the callback with the given id, nullptr if not found
+    Callback* find(size_t id)
+    {
+        if (Callback* callback = m_private.find(id))
+            return callback;
+        return m_public.find(STARTING_PUBLIC_ID - id);
+    }
+
+    /// @returns pointer to the callback with the given id, nullptr if not found
+    const Callback* find(size_t id) const
+    {
+        return const_cast<CallbackStorage*>(this)->find(id);
+    }
+
+    /// @returns true if a callback with the given id existed and was removed
+    bool erase(size_t id)
+    {
+        return m_private.erase(id, m_iterating > 0) || m_public.erase(STARTING_PUBLIC_ID - id, m_iterating > 0);
+    }
+
+    /// @brief removes all public callbacks
+    void clearPublic()
+    {
+        if (m_iterating > 0)
+            m_public.eraseAll();
+        else
+            m_public.clear();
+    }
+
+    inline size_t size() const { return m_private.live + m_public.live; }
+    inline bool empty() const { return size() == 0; }
+
+    /// @brief calls the given function with every callback, private callbacks first then public callbacks, both in id order
+    template <typename Func>
+    void forEach(const Func& func)
+    {
+        IterationGuard guard(*this);
+        m_private.template forEach<true>(func);
+        m_public.template forEach<false>(func);
+    }
+
+    /// @brief calls the given function with every callback spread over the threads of the given pool
+    /// @note callbacks are called in no particular order and the storage must not be changed until this returns
+    template <typename Func>
+    void forEachParallel(ThreadPool& pool, size_t grainSize, const Func& func)
+    {
+        IterationGuard guard(*this);
+
+        const size_t privateCount = m_private.slots.size();
+        pool.parallelFor(privateCount + m_public.slots.size(), grainSize, [this, privateCount, &func](size_t i){
+            auto& slot = (i < privateCount) ? m_private.slots[i] : m_public.slots[i - privateCount];
+            if (slot.key != INVALID_ID)
+                func(slot.callback);
+        });
+    }
+
+private:
+    /// @brief keeps callbacks that are changed while iterating from being moved until the outer most iteration is finished
+    struct IterationGuard
+    {
+        IterationGuard(CallbackStorage& storage) : storage(storage) { ++storage.m_iterating; }
+        ~IterationGuard()
+        {
+            if (--storage.m_iterating == 0)
+            {
+                storage.m_private.finishIteration();
+                storage.m_public.finishIteration();
+            }
+        }
+        CallbackStorage& storage;
+    };
+
+    static constexpr size_t NONE = SIZE_MAX;
+
+    /// @brief maps keys to slots with linear probing, only grows with the number of keys in it
+    /// @note keeps its memory when cleared so connecting after disconnecting does not allocate
+    struct KeyIndex
+    {
+        struct Entry
+        {
+            /// @brief INVALID_ID if the entry is empty
+            size_t key = INVALID_ID;
+            size_t value = NONE;
+        };
+
+        std::vector<Entry> entries;
+        size_t count = 0;
+
+        /// @note keys are mostly sequential so multiplying by an odd number spreads them without collisions
+        inline size_t home(size_t key) const { return (key * 0x9E3779B97F4A7C15ull) & (entries.size() - 1); }
+
+        /// @returns the value of the key or NONE
+        size_t find(size_t key) const
+        {
+            if (count == 0)
+                return NONE;
+            for (size_t i = home(key);; i = (i + 1) & (entries.size() - 1))
+            {
+                if (entries[i].key == key)
+                    return entries[i].value;
+                if (entries[i].key == INVALID_ID)
+                    return NONE;
+            }
+        }
+
+        /// @brief sets the value of the key, adding it if it is not in the index
+        void set(size_t key, size_t value)
+        {
+            if ((count + 1) * 2 > entries.size())
+                grow();
+            size_t i = home(key);
+            while (entries[i].key != INVALID_ID && entries[i].key != key)
+                i = (i + 1) & (entries.size() - 1);
+            if (entries[i].key == INVALID_ID)
+                ++count;
+            entries[i] = {key, value};
+        }
+
+        void erase(size_t key)
+        {
+            const size_t mask = entries.size() - 1;
+            size_t i = home(key);
+            while (entries[i].key != key)
+                i = (i + 1) & mask;
+
+            // moving back the entries after it that would not be found with a gap before them
+            for (size_t j = (i + 1) & mask; entries[j].key != INVALID_ID; j = (j + 1) & mask)
+            {
+                const size_t k = home(entries[j].key);
+                if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j))
+                {
+                    entries[i] = entries[j];
+                    i = j;
+                }
+            }
+            entries[i] = Entry();
+            --count;
+        }
+
+        void clear()
+        {
+            std::fill(entries.begin(), entries.end(), Entry());
+            count = 0;
+        }
+
+        void grow()
+        {
+            std::vector<Entry> old = std::move(entries);
+            entries.assign(std::max<size_t>(16, old.size() * 2), Entry());
+            count = 0;
+            for (const Entry& entry: old)
+            {
+                if (entry.key != INVALID_ID)
+                    set(entry.key, entry.value);
+            }
+        }
+    };
+
+    /// @brief keys always increase in the order they are inserted (private keys are the ids and public keys are the distance from the starting public id)
+    struct Table
+    {
+        struct Slot
+        {
+            size_t key;
+            Callback callback;
+        };
+
+        /// @brief the slot being called by one iteration, iterations started from a callback are linked to the one that called it
+        struct Frame
+        {
+            size_t slot = NONE;
+            /// @brief true if the callback being called was removed, it is destroyed once the outer most call of it returns
+            bool removed = false;
+            Frame* outer;
+        };
+
+        /// @brief flag set in the index for callbacks that are staged
+        static constexpr size_t STAGED = size_t(1) << (sizeof(size_t) * 8 - 1);
+        /// @brief min number of dead slots before the table is compacted outside of an iteration
+        static constexpr size_t MIN_COMPACT = 16;
+
+        /// @brief the callbacks in key order, dead slots have an invalid key
+        std::vector<Slot> slots;
+        /// @brief callbacks added while iterating
+        std::vector<Slot> staged;
+        /// @brief the slot of each key
+        KeyIndex index;
+        /// @brief the inner most iteration, nullptr when not iterating
+        Frame* frames = nullptr;
+        size_t live = 0;
+        size_t dead = 0;
+
+        void insert(size_t key, Callback&& callback, bool iterating)
+        {
+            assert((slots.empty() || slots.back().key == INVALID_ID || key > slots.back().key) && "EventHelper callback keys must increase");
+            if (iterating)
+            {
+                index.set(key, STAGED | staged.size());
+                staged.push_back({key, std::move(callback)});
+            }
+            else
+            {
+                index.set(key, slots.size());
+                slots.push_back({key, std::move(callback)});
+            }
+            ++live;
+        }
+
+        Callback* find(size_t key)
+        {
+            const size_t i = index.find(key);
+            if (i == NONE)
+                return nullptr;
+            return (i & STAGED) ? &staged[i & ~STAGED].callback : &slots[i].callback;
+        }
+
+        bool erase(size_t key, bool iterating)
+        {
+            const size_t i = index.find(key);
+            if (i == NONE)
+                return false;
+            index.erase(key);
+            --live;
+
+            if (i & STAGED)
+            {
+                // staged callbacks are never being called
+                staged[i & ~STAGED].key = INVALID_ID;
+                staged[i & ~STAGED].callback = Callback();
+                return true;
+            }
+            kill(i);
+            if (!iterating)
+                compact(false);
+            return true;
+        }
+
+        /// @brief removes all callbacks without moving any (used while iterating)
+        void eraseAll()
+        {
+            for (size_t i = 0; i < slots.size(); ++i)
+            {
+                if (slots[i].key != INVALID_ID)
+                    kill(i);
+            }
+            for (Slot& slot: staged)
+            {
+                slot.key = INVALID_ID;
+                slot.callback = Callback();
+            }
+            index.clear();
+            live = 0;
+        }
+
+        void clear()
+        {
+            slots.clear();
+            staged.clear();
+            index.clear();
+            live = 0;
+            dead = 0;
+        }
+
+        /// @tparam Forward true to call in increasing key order
+        template <bool Forward, typename Func>
+        void forEach(const Func& func)
+        {
+            // the frame is only removed once the iteration is finished (even if a callback throws)
+            struct FrameGuard
+            {
+                FrameGuard(Table& table) : table(table) { frame.outer = table.frames; table.frames = &frame; }
+                ~FrameGuard()
+                {
+                    table.frames = frame.outer;
+                    // the callback that threw removed itself
+                    if (frame.removed)
+                        table.release(frame.slot);
+                }
+                Table& table;
+                Frame frame;
+            } guard(*this);
+
+            // staged callbacks are never added to the slots while iterating so the size is fixed
+            const size_t size = slots.size();
+            for (size_t n = 0; n < size; ++n)
+            {
+                const size_t i = Forward ? n : size - 1 - n;
+                if (slots[i].key == INVALID_ID)
+                    continue;
+                guard.frame.slot = i;
+                func(slots[i].callback);
+                if (guard.frame.removed)
+                {
+                    guard.frame.removed = false;
+                    guard.frame.slot = NONE;
+                    release(i);
+                }
+            }
+        }
+
+        /// @returns the inner most iteration that is calling the slot or nullptr
+        Frame* findCaller(size_t i) const
+        {
+            for (Frame* frame = frames; frame != nullptr; frame = frame->outer)
+            {
+                if (frame->slot == i)
+                    return frame;
+            }
+            return nullptr;
+        }
+
+        /// @brief destroys the callback of a dead slot unless it is still being called
+        void release(size_t i)
+        {
+            if (Frame* caller = findCaller(i))
+                caller->removed = true;
+            else
+                slots[i].callback = Callback();
+        }
+
+        void finishIteration()
+        {
+            for (Slot& slot: staged)
+            {
+                if (slot.key == INVALID_ID)
+                    continue;
+                index.set(slot.key, slots.size());
+                slots.push_back(std::move(slot));
+            }
+            staged.clear();
+            // every slot was just iterated over so removing the dead ones costs no more than the invoke did
+            compact(true);
+        }
+
+        /// @brief marks the slot as dead and destroys its callback unless it is being called
+        void kill(size_t i)
+        {
+            slots[i].key = INVALID_ID;
+            // the callback could be the one being called, if so it is destroyed once that call returns
+            release(i);
+            ++dead;
+        }
+
+        /// @brief removes dead slots once they make up most of the table (amortized O(1) per erase) or right away if forced
+        void compact(bool force)
+        {
+            if (dead == 0 || (!force && (dead < MIN_COMPACT || dead * 2 < slots.size())))
+                return;
+
+            size_t next = 0;
+            for (size_t i = 0; i < slots.size(); ++i)
+            {
+                if (slots[i].key == INVALID_ID)
+                    continue;
+                if (next != i)
+                {
+                    slots[next] = std::move(slots[i]);
+                    index.set(slots[next].key, next);
+                }
+                ++next;
+            }
+            slots.erase(slots.begin() + next, slots.end());
+            dead = 0;
+        }
+    };
+
+    Table m_private;
+    Table m_public;
+    size_t m_iterating = 0;
+};
+
+class Event;
+
+/// @brief Queue of event calls that are invoked on the thread that calls update
+/// @note adding to the queue is lock free so invoking from other threads never waits for update
+/// @note callbacks are called without any lock held so they can invoke other queued events (they will be called on the next update)
+/// @note removing the calls of an event and destroying an event are O(1) and never touch the queue
+/// @note queues can be owned (create one per thread that needs one) or shared by name with "get", Event::Synchronized uses the queue named "Synchronized"
+class DispatchQueue
+{
+public:
+    /// @brief stats of a queue since it was created or since "resetStats"
+    struct Stats
+    {
+        /// @brief number of calls currently waiting in the queue
+        size_t depth = 0;
+        /// @brief max number of calls that where waiting in the queue at once
+        size_t maxDepth = 0;
+        /// @brief number of calls added to the queue
+        size_t queued = 0;
+        /// @brief number of calls that where invoked by update
+        size_t called = 0;
+        /// @brief number of calls that where removed or whose event was destroyed before they where invoked
+        size_t skipped = 0;
+        /// @brief average ns between a call being queued and being invoked
+        double averageLatency = 0;
+        /// @brief max ns between a call being queued and being invoked
+        uint64_t maxLatency = 0;
+    };
+
+    /// @param name only used to identify the queue
+    explicit DispatchQueue(const std::string& name = "");
+    /// @note calls still in the queue are never invoked
+    ~DispatchQueue();
+
+    DispatchQueue(const DispatchQueue&) = delete;
+    DispatchQueue& operator=(const DispatchQueue&) = delete;
+
+    /// @returns the queue with the given name, creating it if it does not exist yet
+    /// @note the returned queue is never destroyed so keep the reference instead of looking it up every time
+    static DispatchQueue& get(const std::string& name);
+
+    /// @brief invokes all events that where added to this queue
+    /// @note should only be called from the one thread that owns this queue, calling update from a callback of this queue does nothing
+    void update();
+    /// @brief adds the given event to this queue
+    /// @note dont use this unless you know what you are doing, invoke the event with this queue instead
+    /// @note never blocks
+    void addEvent(Event* event, funcHelper::inplaceFunc<void()>&& func, bool removeSameEvents = false);
+    /// @brief removes all queued calls of the given event (from every queue)
+    /// @note O(1), the calls are skipped when update reaches them
+    static void removeEvent(Event* event);
+
+    inline const std::string& getName() const { return m_name; }
+    /// @note can be called from any thread
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    friend class Event;
+
+    /// @brief shared by an event and its queued calls so the calls can check if they are still valid without the event touching the queue
+    /// @note only created the first time an event is queued
+    struct Anchor
+    {
+        inline Anchor(Event* event) : event(event) {}
+
+        /// @brief nullptr once the event is destroyed
+        std::atomic<Event*> event;
+        /// @brief calls queued with an older generation where removed
+        std::atomic<size_t> generation = 0;
+        /// @brief one for the event and one for each queued call, the last to release it deletes it
+        std::atomic<size_t> references = 1;
+        /// @brief number of queued calls of this event that are being invoked right now
+        /// @note the event waits for this to reach zero before it is destroyed
+        std::atomic<size_t> inFlight = 0;
+    };
+
+    struct Node
+    {
+        Anchor* anchor;
+        size_t generation;
+        /// @brief steady clock time in ns of when this call was queued
+        uint64_t queuedTime;
+        funcHelper::inplaceFunc<void()> func;
+        Node* next = nullptr;
+    };
+
+    /// @returns the anchor of the given event, creating it if this is the first time the event was queued
+    static Anchor* getAnchor(Event* event);
+    static void releaseAnchor(Anchor* anchor);
+    /// @brief called when an event is destroyed so its queued calls are skipped
+    /// @note blocks until any call of the event that is already being invoked by another thread returns
+    static void detachEvent(Event* event);
+
+    std::string m_name;
+    /// @brief events added since the last update (newest first)
+    std::atomic<Node*> m_pending = nullptr;
+    /// @brief true while update is calling events
+    bool m_updating = false;
+    #ifndef NDEBUG
+    /// @brief the thread that first called update, used to check that only one thread updates this queue
+    std::atomic<std::thread::id> m_owner;
+    #endif
+
+    std::atomic<size_t> m_depth = 0;
+    std::atomic<size_t> m_maxDepth = 0;
+    std::atomic<size_t> m_queued = 0;
+    std::atomic<size_t> m_called = 0;
+    std::atomic<size_t> m_skipped = 0;
+    std::atomic<uint64_t> m_totalLatency = 0;
+    std::atomic<uint64_t> m_maxLatency = 0;
+};
+
 /// @note when using dynamic events with synchronized calls make sure the synchronized var is set true when invoking
 /// @note connectPrivate is similar to connect but the callbacks can only be removed via there id "disconnectAll()" will not remove private callbacks
 class Event
@@ -26,49 +588,61 @@ public:
     inline Event() = default;
     inline ~Event()
     {
-        // removing pointer to this event in synchronized in case it is still in queue
-        Event::Synchronized::removeEvent(this); // TODO do this better?
+        // any calls of this event still in a queue are skipped (does nothing if this event was never queued)
+        DispatchQueue::detachEvent(this);
+        #ifdef EVENT_HELPER_STATS
+        unregisterStats(m_stats);
+        #endif
     }
 
-    /// @brief Default move constructor
-    Event(Event&& other) noexcept = default;
-    /// @brief Default move assignment operator
-    Event& operator=(Event&& other) noexcept = default;
+    /// @brief Move constructor
+    /// @note synchronized calls that where already queued stay with the moved from event
+    /// @note the stats are moved with the callbacks
+    Event(Event&& other) noexcept : 
+        m_enabled(other.m_enabled), m_callbacks(std::move(other.m_callbacks)), 
+        m_nextPublicID(other.m_nextPublicID), m_nextPrivateID(other.m_nextPrivateID) 
+    {
+        #ifdef EVENT_HELPER_STATS
+        std::swap(m_stats, other.m_stats);
+        #endif
+    }
+    /// @brief Move assignment operator
+    /// @note synchronized calls that where already queued stay with the event they where queued from
+    /// @note the stats are moved with the callbacks
+    Event& operator=(Event&& other) noexcept
+    {
+        if (this != &other)
+        {
+            m_enabled = other.m_enabled;
+            m_callbacks = std::move(other.m_callbacks);
+            m_nextPublicID = other.m_nextPublicID;
+            m_nextPrivateID = other.m_nextPrivateID;
+            #ifdef EVENT_HELPER_STATS
+            std::swap(m_stats, other.m_stats);
+            #endif
+        }
+        return *this;
+    }
 
     /// @brief Connects a function that will be called when this event is invoked
     /// @param func  Callback function that can be passed to the connect function
     /// @param args  Additional arguments to pass to the function
     /// @return Unique id of the connection (specific to this event)
     template <typename Func, typename... BoundArgs>
-    size_t operator()(const Func& func, const BoundArgs&... args)
+    size_t operator()(Func&& func, BoundArgs&&... args)
     {
-        return connect(func, args...);
+        return connect(std::forward<Func>(func), std::forward<BoundArgs>(args)...);
     }
 
     /// @brief Connects a function that will be called when this event is invoked
     /// @param func  Callback function that can be passed to the connect function
     /// @param args  Additional arguments to pass to the function
+    /// @note the function and bound arguments are moved in when given as rvalues (so they can be move only) and copied otherwise
     /// @return Unique id of the connection (specific to this event)
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    size_t connect(const Func& func, const BoundArgs&... args)
+    template <typename Func, typename... BoundArgs, typename std::enable_if_t<funcHelper::isBindable<void, Func, BoundArgs...>>* = nullptr>
+    size_t connect(Func&& func, BoundArgs&&... args)
     {
-        const size_t id = m_nextPublicID--;
-
-        assert(id > m_nextPrivateID && "EventHelper Callback id overflow" && __PRETTY_FUNCTION__);
-        #ifndef EVENT_HELPER_DONT_THROW
-        if (id <= m_nextPrivateID)
-            throw std::runtime_error("EventHelper callback id overflow" + std::string(__PRETTY_FUNCTION__));
-        #endif
-
-        if constexpr(sizeof...(BoundArgs) == 0)
-            m_callbacks[id] = func;
-        else
-        {
-            m_callbacks[id] = [=]{ 
-                invokeFunc(func, args...); 
-            };
-        }
-        return id;
+        return addCallback(bind(std::forward<Func>(func), std::forward<BoundArgs>(args)...), false);
     }
 
     /// @brief Connects a function that will be called when this event is invoked
@@ -76,26 +650,10 @@ public:
     /// @param args  Additional arguments to pass to the function
     /// @note private callbacks can only be removed via there id "disconnectAll()" will not remove them
     /// @return Unique id of the connection (specific to this event)
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    size_t connectPrivate(const Func& func, const BoundArgs&... args)
+    template <typename Func, typename... BoundArgs, typename std::enable_if_t<funcHelper::isBindable<void, Func, BoundArgs...>>* = nullptr>
+    size_t connectPrivate(Func&& func, BoundArgs&&... args)
     {
-        const size_t id = m_nextPrivateID++;
-        
-        assert(id < m_nextPublicID && "EventHelper Callback id overflow" && __PRETTY_FUNCTION__);
-        #ifndef EVENT_HELPER_DONT_THROW
-        if (id >= m_nextPublicID)
-            throw std::runtime_error("EventHelper callback id overflow" + std::string(__PRETTY_FUNCTION__));
-        #endif
-
-        if constexpr(sizeof...(BoundArgs) == 0)
-            m_callbacks[id] = func;
-        else
-        {
-            m_callbacks[id] = [=]{ 
-                invokeFunc(func, args...); 
-            };
-        }
-        return id;
+        return addCallback(bind(std::forward<Func>(func), std::forward<BoundArgs>(args)...), true);
     }
 
     /// @brief Disconnect a function from this event
@@ -106,25 +664,10 @@ public:
     /// @brief changes the callback with the given id
     /// @param id Unique id of the callback returned by the connect function
     /// @return True if callback was found and changed
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    bool setCallback(size_t id, const Func& func, const BoundArgs&... args)
+    template <typename Func, typename... BoundArgs, typename std::enable_if_t<funcHelper::isBindable<void, Func, BoundArgs...>>* = nullptr>
+    bool setCallback(size_t id, Func&& func, BoundArgs&&... args)
     {
-        auto callback = m_callbacks.find(id);
-        if (callback != m_callbacks.end())
-        {
-            if constexpr(sizeof...(BoundArgs) == 0)
-                callback->second = func;
-            else
-            {
-                callback->second = [=]{ 
-                    invokeFunc(func, args...); 
-                };
-            } 
-
-            return true;
-        }
-
-        return false;
+        return replaceCallback(id, bind(std::forward<Func>(func), std::forward<BoundArgs>(args)...));
     }
 
     /// @brief Disconnect all public function from this event
@@ -138,6 +681,16 @@ public:
     /// @note private callbacks are invoked before public callbacks
     void invoke(bool synchronized = false, bool removeOtherInstances = false);
 
+    /// @brief Call all connected functions on the thread that updates the given queue
+    /// @param removeOtherInstances if true will remove any other queued calls of this event before adding
+    void invoke(DispatchQueue& queue, bool removeOtherInstances = false);
+
+    /// @brief Call all connected functions at once spread over the threads of the given pool, returns once they have all finished
+    /// @param grainSize number of callbacks a thread takes at a time, larger is better for cheap callbacks
+    /// @note only worth it for events with many independent callbacks that take a while to run
+    /// @warning callbacks are called at the same time in no particular order and must not connect or disconnect callbacks of this event
+    void invokeParallel(size_t grainSize = 1, ThreadPool& pool = ThreadPool::getShared());
+
     /// @brief Changes whether this event calls the connected functions when triggered
     /// @param enabled  Is the event enabled?
     /// events are enabled by default. Temporarily disabling the event is the better alternative to disconnecting the
@@ -162,50 +715,171 @@ public:
     inline size_t getNextPublicID() const { return m_nextPublicID; }
     inline size_t getNextPrivateID() const { return m_nextPrivateID; }
 
+    /// @brief sets the name this event is shown with in its stats
+    /// @note does nothing if EVENT_HELPER_STATS is not defined
+    void setStatsName(const std::string& name);
+    /// @returns the stats of this event (empty if EVENT_HELPER_STATS is not defined)
+    /// @note can be called from any thread
+    EventStats getStats() const;
+    void resetStats();
+
+    /// @returns the stats of every event that currently exists with the events that spent the most time in there callbacks first
+    /// @note empty if EVENT_HELPER_STATS is not defined
+    /// @note can be called from any thread
+    static std::vector<EventStats> getAllStats();
+    /// @brief resets the stats of every event
+    static void resetAllStats();
+    /// @param maxEvents the max number of events to include (the ones that spent the most time in there callbacks)
+    /// @returns the stats of every event as json
+    static std::string dumpStats(size_t maxEvents = SIZE_MAX);
+    /// @brief adds the "events" command to the command handler ("events stats", "events dump", and "events reset")
+    /// @note does nothing if CommandHandler.hpp is not available
+    static void initCommand();
+
+    /// @brief The queue that synchronized invokes are added to (the DispatchQueue named "Synchronized")
+    /// @note update is normally called by the main loop
     class Synchronized
     {
     public:
         /// @brief Call this first thing every frame
         /// @note invokes all events that where called with the synchronized flag
-        static void update();
-        /// @brief used when an event is destroyed in case its still in the queue
-        /// @note removes all instances of the given event from the queue
-        static void removeEvent(Event* event);
+        /// @note should only be called from one thread, calling update from a synchronized callback does nothing
+        static inline void update() { getQueue().update(); }
+        /// @brief removes all queued calls of the given event
+        /// @note O(1), the calls are skipped when update reaches them
+        static inline void removeEvent(Event* event) { DispatchQueue::removeEvent(event); }
         /// @brief adds the given event to the synchronized queue and copys any data needed to call it
         /// @note dont use this unless you know what you are doing
         /// @note set synchronized = true when invoking from the event
-        static void addEvent(Event* event, std::function<void()>&& func, bool removeSameEvents = false)
-        {
-            m_lock.lock();
-            if (removeSameEvents)
-                m_events.remove_if(
-                [event](const std::pair<EventHelper::Event *, std::function<void()>>& v){
-                    return v.first == event;
-                });
-            m_events.emplace_back(event, func);
-            m_lock.unlock();
+        /// @note never blocks
+        static inline void addEvent(Event* event, funcHelper::inplaceFunc<void()>&& func, bool removeSameEvents = false) 
+        { 
+            getQueue().addEvent(event, std::move(func), removeSameEvents); 
         }
+        /// @returns the queue that synchronized invokes are added to
+        static DispatchQueue& getQueue();
 
     private:
         inline Synchronized() = default;
-
-        static std::mutex m_lock;
-        static std::list<std::pair<Event*, std::function<void()>>> m_events;
     };
 
 protected:
+    friend class DispatchQueue;
+
+    /// @brief callbacks are given a pointer to the parameters of the current invoke (nullptr for events without parameters)
+    /// @note the parameters are a tuple of references made by the event being invoked, see "funcHelper::bindDynamic"
+    /// @note callbacks are stored without allocating unless they are bigger than FUNC_HELPER_INPLACE_CAPACITY
+    using CallbackFunc = funcHelper::inplaceFunc<void(const void*)>;
+
+    #ifdef EVENT_HELPER_STATS
+    /// @brief the stats of one callback
+    /// @note shared between the callback and the stats of its event so the stats can be read from any thread
+    struct CallbackCounters
+    {
+        inline CallbackCounters(size_t id) : id(id) {}
+
+        void record(uint64_t time);
+        CallbackStats get() const;
+        void reset();
+
+        const size_t id;
+        std::atomic<uint64_t> calls = 0;
+        std::atomic<uint64_t> totalTime = 0;
+        std::atomic<uint64_t> maxTime = 0;
+        std::array<std::atomic<uint64_t>, STATS_HISTOGRAM_BUCKETS> histogram{};
+    };
+
+    /// @brief times every call of the callback
+    struct Callback
+    {
+        inline Callback() = default;
+        template <typename Func, typename std::enable_if_t<!std::is_same_v<std::decay_t<Func>, Callback>>* = nullptr>
+        inline Callback(Func&& func) : func(std::forward<Func>(func)) {}
+
+        void operator()(const void* params) const;
+
+        CallbackFunc func;
+        std::shared_ptr<CallbackCounters> counters;
+    };
+
+    /// @brief the stats of an event
+    /// @note kept separate from the event so moving the event keeps them at the same address for the list of all stats
+    struct StatsRecorder
+    {
+        /// @brief records the time spent calling the callbacks once
+        void recordInvoke(uint64_t time, size_t subscribers);
+        void recordQueueWait(uint64_t time);
+        /// @returns the counters for a new callback with the given id
+        std::shared_ptr<CallbackCounters> addCallback(size_t id);
+        EventStats get() const;
+        void reset();
+
+        std::atomic<uint64_t> invokes = 0;
+        std::atomic<size_t> subscribers = 0;
+        std::atomic<uint64_t> totalTime = 0;
+        std::atomic<uint64_t> maxTime = 0;
+        std::atomic<uint64_t> queuedCalls = 0;
+        std::atomic<uint64_t> totalQueueWait = 0;
+        std::atomic<uint64_t> maxQueueWait = 0;
+
+        /// @brief locks the name and callbacks
+        mutable std::mutex lock;
+        std::string name;
+        /// @brief counters of callbacks that where disconnected are removed once only this holds them
+        std::vector<std::shared_ptr<CallbackCounters>> callbacks;
+        /// @brief the number of callbacks at which the disconnected ones are removed next
+        size_t pruneSize = 16;
+    };
+
+    /// @brief creates the stats for a new event and adds them to the list of all stats
+    static StatsRecorder* registerStats();
+    static void unregisterStats(StatsRecorder* stats);
+    #else
+    using Callback = CallbackFunc;
+    #endif
+
     /// @brief Copy constructor which will not copy the callbacks
     Event(const Event& other) = delete;
     /// @brief Copy assignment operator which will not copy the callbacks
     Event& operator=(const Event& other) = delete;
 
-    void _invoke();
+    /// @param params pointer to the parameters of this invoke, only valid for the duration of the call
+    void _invoke(const void* params = nullptr);
+    /// @param params pointer to the parameters of this invoke, only valid for the duration of the call
+    void _invokeParallel(size_t grainSize, ThreadPool& pool, const void* params = nullptr);
+
+    /// @brief adds the callback under a new public or private id
+    /// @returns the id of the callback
+    size_t addCallback(Callback&& callback, bool isPrivate)
+    {
+        const size_t id = isPrivate ? m_nextPrivateID++ : m_nextPublicID--;
+
+        assert(m_nextPrivateID <= m_nextPublicID && "EventHelper Callback id overflow" && __PRETTY_FUNCTION__);
+        #ifndef EVENT_HELPER_DONT_THROW
+        if (m_nextPrivateID > m_nextPublicID)
+            throw std::runtime_error("EventHelper callback id overflow" + std::string(__PRETTY_FUNCTION__));
+        #endif
+
+        #ifdef EVENT_HELPER_STATS
+        callback.counters = m_stats->addCallback(id);
+        #endif
+        m_callbacks.insert(id, isPrivate, std::move(callback));
+        return id;
+    }
 
-    /// @brief Turns the void* parameters back into its original type right before calling the callback function
-    template <typename Type>
-    static const std::decay_t<Type>& dereferenceParam(std::size_t paramIndex)
+    /// @returns true if the callback with the given id was found and replaced
+    bool replaceCallback(size_t id, Callback&& callback)
     {
-        return *static_cast<const std::decay_t<Type>*>(m_parameters[paramIndex]);
+        Callback* current = m_callbacks.find(id);
+        if (current == nullptr)
+            return false;
+
+        #ifdef EVENT_HELPER_STATS
+        // the stats are for the id not the function
+        callback.counters = std::move(current->counters);
+        #endif
+        *current = std::move(callback);
+        return true;
     }
 
     template <typename Func, typename... Args>
@@ -214,381 +888,251 @@ protected:
         std::invoke(std::forward<Func>(func), std::forward<Args>(args)...);
     }
 
+    /// @returns a callback that calls the function with the bound arguments (moved in when given as rvalues)
+    template <typename Func, typename... BoundArgs>
+    static auto bind(Func&& func, BoundArgs&&... args)
+    {
+        return [func = std::forward<Func>(func), ...args = std::forward<BoundArgs>(args)](const void*) mutable { invokeFunc(func, args...); };
+    }
+
     bool m_enabled = true;
     //!!!! dont change this unless order is no longer required for callbacks
     // private are called first since there ids start a 0 and increase
-    std::map<size_t, std::function<void()>> m_callbacks; 
+    CallbackStorage<Callback> m_callbacks;
 
     // Possible issue if event are constantly removed and added
     size_t m_nextPublicID = STARTING_PUBLIC_ID;
     size_t m_nextPrivateID = STARTING_PRIVATE_ID;
-    static std::deque<const void*> m_parameters;
+
+    /// @brief only set once this event has been added to a queue
+    std::atomic<DispatchQueue::Anchor*> m_anchor = nullptr;
+
+    #ifdef EVENT_HELPER_STATS
+    StatsRecorder* m_stats = registerStats();
+    #endif
 };
 
-#define CONNECT_NO_PARAMS() \
-    template <typename Func, typename... BoundArgs> \
-    size_t operator()(const Func& func, const BoundArgs&... args) \
-    { \
-        return connect(func, args...); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr> \
-    size_t connect(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connect(func, args...); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr> \
-    size_t connectPrivate(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connectPrivate(func, args...); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr> \
-    bool setCallback(size_t id, const Func& func, const BoundArgs&... args) \
-    { \
-        auto callback = m_callbacks.find(id); \
-        if (callback != m_callbacks.end()) \
-        { \
-            if constexpr(sizeof...(BoundArgs) == 0) \
-                callback->second = func; \
-            else \
-            { \
-                callback->second = [=]{  \
-                    invokeFunc(func, args...);  \
-                }; \
-            }  \
-            return true; \
-        } \
-        return false; \
-    }
-
-#define CONNECT_ONE_PARAM() \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr> \
-    size_t connect(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connect([=]{ invokeFunc(func, args..., dereferenceParam<T>(0)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr> \
-    size_t connectPrivate(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connectPrivate([=]{ invokeFunc(func, args..., dereferenceParam<T>(0)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr> \
-    bool setCallback(size_t id, const Func& func, const BoundArgs&... args) \
-    { \
-        auto callback = m_callbacks.find(id); \
-        if (callback != m_callbacks.end()) \
-        { \
-            callback->second = [=]{  \
-                invokeFunc(func, args..., dereferenceParam<T>(0));  \
-            }; \
-            return true; \
-        } \
-        return false; \
-    }
-
-#define CONNECT_TWO_PARAMS() \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr> \
-    size_t connect(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connect([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr> \
-    size_t connectPrivate(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connectPrivate([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr> \
-    bool setCallback(size_t id, const Func& func, const BoundArgs&... args) \
-    { \
-        auto callback = m_callbacks.find(id); \
-        if (callback != m_callbacks.end()) \
-        { \
-            callback->second = [=]{  \
-                invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1));  \
-            }; \
-            return true; \
-        } \
-        return false; \
-    }
-
-#define CONNECT_THREE_PARAMS() \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value>* = nullptr> \
-    size_t connect(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connect([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value>* = nullptr> \
-    size_t connectPrivate(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connectPrivate([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value>* = nullptr> \
-    bool setCallback(size_t id, const Func& func, const BoundArgs&... args) \
-    { \
-        auto callback = m_callbacks.find(id); \
-        if (callback != m_callbacks.end()) \
-        { \
-            callback->second = [=]{  \
-                invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2));  \
-            }; \
-            return true; \
-        } \
-        return false; \
-    }
-
-#define CONNECT_FOUR_PARAMS() \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4)>>::value>* = nullptr> \
-    size_t connect(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connect([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4)>>::value>* = nullptr> \
-    size_t connectPrivate(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connectPrivate([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4)>>::value>* = nullptr> \
-    bool setCallback(size_t id, const Func& func, const BoundArgs&... args) \
-    { \
-        auto callback = m_callbacks.find(id); \
-        if (callback != m_callbacks.end()) \
-        { \
-            callback->second = [=]{  \
-                invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3));  \
-            }; \
-            return true; \
-        } \
-        return false; \
-    }
-
-#define CONNECT_FIVE_PARAMS() \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4, T5)>>::value>* = nullptr> \
-    size_t connect(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connect([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3), dereferenceParam<T5>(4)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4, T5)>>::value>* = nullptr> \
-    size_t connectPrivate(const Func& func, const BoundArgs&... args) \
-    { \
-        return Event::connectPrivate([=]{ invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3), dereferenceParam<T5>(4)); }); \
-    } \
-    template <typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4, T5)>>::value>* = nullptr> \
-    bool setCallback(size_t id, const Func& func, const BoundArgs&... args) \
-    { \
-        auto callback = m_callbacks.find(id); \
-        if (callback != m_callbacks.end()) \
-        { \
-            callback->second = [=]{  \
-                invokeFunc(func, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3), dereferenceParam<T5>(4));  \
-            }; \
-            return true; \
-        } \
-        return false; \
-    }
-
-/// Optional unbound parameters:
-/// - T (value according to template parameter
-template <typename T>
+/// @brief Event with dynamic parameters that are given when invoking
+/// @note callbacks can take any number of bound arguments (given when connecting) followed by any number of the dynamic parameters (from the front)
+/// @note parameters are given to the callbacks by reference (const unless the parameter type is a non const reference) so invoking does not copy them
+template <typename... Ts>
 class EventDynamic : public Event
 {
+protected:
+    /// @brief the parameters given to the callbacks while invoking
+    using Params = std::tuple<funcHelper::dynamicParam<Ts>...>;
+
+    /// @brief true if the function can be called with the bound arguments followed by some of the dynamic parameters
+    template <typename Func, typename... BoundArgs>
+    static constexpr bool canConnect = funcHelper::dynamicParamCount<void, Func, std::tuple<BoundArgs...>, Params>() != funcHelper::INVALID_PARAM_COUNT;
+
 public:
 
     /// @brief Constructor
     inline EventDynamic() = default;
 
-    CONNECT_NO_PARAMS();
-    CONNECT_ONE_PARAM();
+    /// @brief Connects a function that will be called when this event is invoked
+    /// @param func  Callback function that can be passed to the connect function
+    /// @param args  Additional arguments to pass to the function (given before the dynamic parameters)
+    /// @return Unique id of the connection (specific to this event)
+    template <typename Func, typename... BoundArgs, typename std::enable_if_t<canConnect<Func, BoundArgs...>>* = nullptr>
+    size_t operator()(Func&& func, BoundArgs&&... args)
+    {
+        return connect(std::forward<Func>(func), std::forward<BoundArgs>(args)...);
+    }
+
+    /// @brief Connects a function that will be called when this event is invoked
+    /// @param func  Callback function that can be passed to the connect function
+    /// @param args  Additional arguments to pass to the function (given before the dynamic parameters)
+    /// @note the function and bound arguments are moved in when given as rvalues (so they can be move only) and copied otherwise
+    /// @return Unique id of the connection (specific to this event)
+    template <typename Func, typename... BoundArgs, typename std::enable_if_t<canConnect<Func, BoundArgs...>>* = nullptr>
+    size_t connect(Func&& func, BoundArgs&&... args)
+    {
+        return addCallback(funcHelper::bindDynamic<void, Params>(std::forward<Func>(func), std::forward<BoundArgs>(args)...), false);
+    }
+
+    /// @brief Connects a function that will be called when this event is invoked
+    /// @param func  Callback function that can be passed to the connect function
+    /// @param args  Additional arguments to pass to the function (given before the dynamic parameters)
+    /// @note private callbacks can only be removed via there id "disconnectAll()" will not remove them
+    /// @return Unique id of the connection (specific to this event)
+    template <typename Func, typename... BoundArgs, typename std::enable_if_t<canConnect<Func, BoundArgs...>>* = nullptr>
+    size_t connectPrivate(Func&& func, BoundArgs&&... args)
+    {
+        return addCallback(funcHelper::bindDynamic<void, Params>(std::forward<Func>(func), std::forward<BoundArgs>(args)...), true);
+    }
+
+    /// @brief changes the callback with the given id
+    /// @param id Unique id of the callback returned by the connect function
+    /// @return True if callback was found and changed
+    template <typename Func, typename... BoundArgs, typename std::enable_if_t<canConnect<Func, BoundArgs...>>* = nullptr>
+    bool setCallback(size_t id, Func&& func, BoundArgs&&... args)
+    {
+        return replaceCallback(id, funcHelper::bindDynamic<void, Params>(std::forward<Func>(func), std::forward<BoundArgs>(args)...));
+    }
 
     /// @brief Call all connected callbacks
-    /// @param param   Parameter that will be passed to callback function if it has an unbound parameter
-    /// @param synchronized if true this event will be called on EventHelper::Event::Synchronized::update() 
+    /// @param params  Parameters that will be passed to the callback functions that take them
+    /// @param synchronized if true this event will be called on EventHelper::Event::Synchronized::update() (the parameters are copied)
+    /// @param removeOtherInstances if true will remove any other synchronized calls of this event before adding
     /// @note if called as synchronized then returns true if there is at least one callback connected
     /// @return True when a callback function was executed, false when there weren't any connected callback functions
-    bool invoke(T param, bool synchronized = false, bool removeOtherInstances = false)
+    bool invoke(funcHelper::dynamicParam<Ts>... params, bool synchronized = false, bool removeOtherInstances = false)
     {
         if (m_callbacks.empty() || !m_enabled)
             return false;
 
         if (synchronized)
-        {
-            // if (removeOtherInstances) Event::Synchronized::removeEvent(this);
-            Event::Synchronized::addEvent(this, [this, param]{ Event::invokeFunc(&EventDynamic::invoke, this, param, false, false); }, removeOtherInstances);
-            return true;
-        }
+            return this->invoke(params..., Event::Synchronized::getQueue(), removeOtherInstances);
 
-        m_parameters[0] = static_cast<const void*>(&param);
-        Event::_invoke();
+        const Params paramsTuple(params...);
+        Event::_invoke(&paramsTuple);
         return true;
     }
-};
-
-/// Optional unbound parameters:
-/// - T (value according to template parameter
-template <typename T, typename T2>
-class EventDynamic2 : public Event
-{
-public:
-
-    /// @brief Constructor
-    EventDynamic2()
-    {}
-
-    CONNECT_NO_PARAMS();
-    CONNECT_ONE_PARAM();
-    CONNECT_TWO_PARAMS();
 
-    /// @brief Call all connected callbacks
-    /// @param synchronized if true this event will be called on EventHelper::Event::Synchronized::update() 
-    /// @param param   Parameter that will be passed to callback function if it has an unbound parameter
-    /// @note if called as synchronized then returns true if there is at least one callback connected
+    /// @brief Call all connected callbacks at once spread over the threads of the given pool, returns once they have all finished
+    /// @param params  Parameters that will be passed to the callback functions that take them
+    /// @param grainSize number of callbacks a thread takes at a time, larger is better for cheap callbacks
+    /// @warning callbacks are called at the same time in no particular order and must not connect or disconnect callbacks of this event
     /// @return True when a callback function was executed, false when there weren't any connected callback functions
-    bool invoke(T param, T2 param2, bool synchronized = false, bool removeOtherInstances = false)
+    bool invokeParallel(funcHelper::dynamicParam<Ts>... params, size_t grainSize = 1, ThreadPool& pool = ThreadPool::getShared())
     {
         if (m_callbacks.empty() || !m_enabled)
             return false;
 
-        if (synchronized)
-        {
-            // if (removeOtherInstances) Event::Synchronized::removeEvent(this);
-            Event::Synchronized::addEvent(this, [this, param, param2]{ Event::invokeFunc(&EventDynamic2::invoke, this, param, param2, false, false); }, removeOtherInstances);
-            return true;
-        }
-
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        Event::_invoke();
+        const Params paramsTuple(params...);
+        Event::_invokeParallel(grainSize, pool, &paramsTuple);
         return true;
     }
-};
-
-/// Optional unbound parameters:
-/// - T (value according to template parameter
-template <typename T, typename T2, typename T3>
-class EventDynamic3 : public Event
-{
-public:
-
-    /// @brief Constructor
-    EventDynamic3()
-    {}
 
-    CONNECT_NO_PARAMS();
-    CONNECT_ONE_PARAM();
-    CONNECT_TWO_PARAMS();
-    CONNECT_THREE_PARAMS();
-
-    /// @brief Call all connected callbacks
-    /// @param synchronized if true this event will be called on EventHelper::Event::Synchronized::update() 
-    /// @param param   Parameter that will be passed to callback function if it has an unbound parameter
-    /// @note if called as synchronized then returns true if there is at least one callback connected
-    /// @return True when a callback function was executed, false when there weren't any connected callback functions
-    bool invoke(T param, T2 param2, T3 param3, bool synchronized = false, bool removeOtherInstances = false)
+    /// @brief Call all connected callbacks on the thread that updates the given queue
+    /// @param params  Parameters that will be passed to the callback functions that take them (they are copied)
+    /// @param removeOtherInstances if true will remove any other queued calls of this event before adding
+    /// @return True if there is at least one callback connected
+    bool invoke(funcHelper::dynamicParam<Ts>... params, DispatchQueue& queue, bool removeOtherInstances = false)
     {
         if (m_callbacks.empty() || !m_enabled)
             return false;
 
-        if (synchronized)
-        {
-            // if (removeOtherInstances) Event::Synchronized::removeEvent(this);
-            Event::Synchronized::addEvent(this, [this, param, param2, param3]{ Event::invokeFunc(&EventDynamic3::invoke, this, param, param2, param3, false, false); }, removeOtherInstances);
-            return true;
-        }
-
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        Event::_invoke();
+        queue.addEvent(this, [this, copies = std::tuple<std::remove_cvref_t<Ts>...>(params...)]() mutable { 
+            std::apply([this](auto&... params){ this->invoke(params..., false, false); }, copies); 
+        }, removeOtherInstances);
         return true;
     }
 };
 
-/// Optional unbound parameters:
-/// - T (value according to template parameter
-template <typename T, typename T2, typename T3, typename T4>
-class EventDynamic4 : public Event
+/// @brief Event that collects payloads and gives all of them to each callback at once when flushed
+/// @note callbacks take a std::span<const T> of every payload pushed since the last flush (plus any bound arguments)
+/// @note for events that fire many times per frame, each callback is called once per flush instead of once per payload
+/// @note the payload buffers are kept between flushes so pushing does not allocate once they are big enough
+/// @warning pushing and flushing are not thread safe
+template <typename T>
+class EventBatched : public EventDynamic<std::span<const T>>
 {
 public:
-
     /// @brief Constructor
-    EventDynamic4()
-    {}
-
-    CONNECT_NO_PARAMS();
-    CONNECT_ONE_PARAM();
-    CONNECT_TWO_PARAMS();
-    CONNECT_THREE_PARAMS();
-    CONNECT_FOUR_PARAMS();
-
-    /// @brief Call all connected callbacks
-    /// @param synchronized if true this event will be called on EventHelper::Event::Synchronized::update() 
-    /// @param param   Parameter that will be passed to callback function if it has an unbound parameter
-    /// @note if called as synchronized then returns true if there is at least one callback connected
-    /// @return True when a callback function was executed, false when there weren't any connected callback functions
-    bool invoke(T param, T2 param2, T3 param3, T4 param4, bool synchronized = false, bool removeOtherInstances = false)
+    inline EventBatched() = default;
+
+    /// @brief adds the payload to the next flush
+    inline void push(const T& payload) { m_payloads.push_back(payload); }
+    /// @brief adds the payload to the next flush
+    inline void push(T&& payload) { m_payloads.push_back(std::move(payload)); }
+    /// @brief constructs a payload for the next flush in place
+    /// @returns the constructed payload (only valid until the next push)
+    template <typename... Args>
+    inline T& emplace(Args&&... args) { return m_payloads.emplace_back(std::forward<Args>(args)...); }
+
+    /// @brief gives every payload pushed since the last flush to each callback
+    /// @note payloads pushed while flushing are kept for the next flush, calling flush from a callback does nothing
+    /// @return True when a callback function was executed, false when there weren't any callbacks or payloads
+    bool flush()
     {
-        if (m_callbacks.empty() || !m_enabled)
+        if (m_flushing || m_payloads.empty())
             return false;
 
-        if (synchronized)
+        // swapping so payloads pushed by callbacks go into the other buffer
+        std::swap(m_payloads, m_delivering);
+        struct FlushGuard
         {
-            // if (removeOtherInstances) Event::Synchronized::removeEvent(this);
-            Event::Synchronized::addEvent(this, [this, param, param2, param3, param4]{ Event::invokeFunc(&EventDynamic4::invoke, this, param, param2, param3, param4, false, false); }, removeOtherInstances);
-            return true;
-        }
+            ~FlushGuard() { event.m_delivering.clear(); event.m_flushing = false; }
+            EventBatched& event;
+        } guard{*this};
+        m_flushing = true;
 
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        m_parameters[3] = static_cast<const void*>(&param4);
-        Event::_invoke();
-        return true;
+        return this->invoke(std::span<const T>(m_delivering.data(), m_delivering.size()));
     }
-};
 
-/// Optional unbound parameters:
-/// - T (value according to template parameter
-template <typename T, typename T2, typename T3, typename T4, typename T5>
-class EventDynamic5 : public Event
-{
-public:
-
-    /// @brief Constructor
-    EventDynamic5()
-    {}
+    /// @brief gives every payload pushed since the last flush to each callback on the thread that updates the given queue
+    /// @note the payloads are moved into the queued call so pushing can continue right away
+    /// @param removeOtherInstances if true will remove any other queued calls of this event before adding (there payloads are dropped)
+    /// @return True if there is at least one callback connected and at least one payload
+    bool flush(DispatchQueue& queue, bool removeOtherInstances = false)
+    {
+        if (m_payloads.empty() || this->m_callbacks.empty() || !this->m_enabled)
+            return false;
 
-    CONNECT_NO_PARAMS();
-    CONNECT_ONE_PARAM();
-    CONNECT_TWO_PARAMS();
-    CONNECT_THREE_PARAMS();
-    CONNECT_FOUR_PARAMS();
-    CONNECT_FIVE_PARAMS();
+        std::vector<T> payloads;
+        payloads.reserve(m_payloads.capacity());
+        std::swap(payloads, m_payloads);
+        return this->queueOwned(std::move(payloads), queue, removeOtherInstances);
+    }
 
-    /// @brief Call all connected callbacks
-    /// @param synchronized if true this event will be called on EventHelper::Event::Synchronized::update() 
-    /// @param param   Parameter that will be passed to callback function if it has an unbound parameter
-    /// @note if called as synchronized then returns true if there is at least one callback connected
+    /// @brief Call all connected callbacks with the given payloads
+    /// @param synchronized if true this event will be called on EventHelper::Event::Synchronized::update() (the payloads are copied)
+    /// @param removeOtherInstances if true will remove any other synchronized calls of this event before adding
     /// @return True when a callback function was executed, false when there weren't any connected callback functions
-    bool invoke(T param, T2 param2, T3 param3, T4 param4, T5 param5, bool synchronized = false, bool removeOtherInstances = false)
+    bool invoke(std::span<const T> payloads, bool synchronized = false, bool removeOtherInstances = false)
     {
-        if (m_callbacks.empty() || !m_enabled)
+        if (synchronized)
+            return this->invoke(payloads, Event::Synchronized::getQueue(), removeOtherInstances);
+        return EventDynamic<std::span<const T>>::invoke(payloads, false, false);
+    }
+
+    /// @brief Call all connected callbacks with the given payloads on the thread that updates the given queue
+    /// @note the payloads are copied since the span only views storage owned by the caller
+    /// @param removeOtherInstances if true will remove any other queued calls of this event before adding
+    /// @return True if there is at least one callback connected
+    bool invoke(std::span<const T> payloads, DispatchQueue& queue, bool removeOtherInstances = false)
+    {
+        if (this->m_callbacks.empty() || !this->m_enabled)
             return false;
 
-        if (synchronized)
-        {
-            // if (removeOtherInstances) Event::Synchronized::removeEvent(this);
-            Event::Synchronized::addEvent(this, [this, param, param2, param3, param4, param5]{ Event::invokeFunc(&EventDynamic5::invoke, this, param, param2, param3, param4, param5, false, false); }, removeOtherInstances);
-            return true;
-        }
+        return this->queueOwned(std::vector<T>(payloads.begin(), payloads.end()), queue, removeOtherInstances);
+    }
+
+    /// @returns the number of payloads that will be given on the next flush
+    inline size_t getPendingCount() const { return m_payloads.size(); }
+    /// @brief removes all payloads pushed since the last flush
+    inline void clearPending() { m_payloads.clear(); }
+    /// @brief reserves space for the given number of payloads per flush
+    inline void reserve(size_t count) { m_payloads.reserve(count); m_delivering.reserve(count); }
 
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        m_parameters[3] = static_cast<const void*>(&param4);
-        m_parameters[4] = static_cast<const void*>(&param5);
-        Event::_invoke();
+private:
+    /// @brief queues a call that gives the owned payloads to the callbacks
+    bool queueOwned(std::vector<T>&& payloads, DispatchQueue& queue, bool removeOtherInstances)
+    {
+        queue.addEvent(this, [this, payloads = std::move(payloads)]() { 
+            EventDynamic<std::span<const T>>::invoke(std::span<const T>(payloads.data(), payloads.size()), false, false); 
+        }, removeOtherInstances);
         return true;
     }
+
+    std::vector<T> m_payloads;
+    /// @brief the payloads currently being given to the callbacks
+    std::vector<T> m_delivering;
+    bool m_flushing = false;
 };
 
+template <typename T, typename T2>
+using EventDynamic2 = EventDynamic<T, T2>;
+template <typename T, typename T2, typename T3>
+using EventDynamic3 = EventDynamic<T, T2, T3>;
+template <typename T, typename T2, typename T3, typename T4>
+using EventDynamic4 = EventDynamic<T, T2, T3, T4>;
+template <typename T, typename T2, typename T3, typename T4, typename T5>
+using EventDynamic5 = EventDynamic<T, T2, T3, T4, T5>;
+
 }
 
 #endif
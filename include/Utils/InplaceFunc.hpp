@@ -0,0 +1,250 @@
+#ifndef INPLACE_FUNC_H
+#define INPLACE_FUNC_H
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <typeinfo>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+/// @brief number of bytes a funcHelper::inplaceFunc can store without allocating
+/// @note can be defined before including to change the default capacity
+#ifndef FUNC_HELPER_INPLACE_CAPACITY
+#define FUNC_HELPER_INPLACE_CAPACITY 48
+#endif
+/// @brief if defined then callables that are too big for an inplaceFunc are a compile error instead of being heap allocated
+// #define FUNC_HELPER_INPLACE_NO_HEAP
+
+namespace funcHelper
+{
+template <typename Signature, std::size_t Capacity = FUNC_HELPER_INPLACE_CAPACITY, bool Copyable = false>
+class inplaceFunc;
+
+/// @brief Similar to std::function but the callable is stored inside the object instead of on the heap
+/// @tparam Capacity the max size of a callable that will be stored without allocating
+/// @tparam Copyable if false this is move only, if true this can be copied and storing a callable that can not be copied is a compile error
+/// @note callables that are too big (or can throw when moved) are heap allocated unless FUNC_HELPER_INPLACE_NO_HEAP is defined
+template <typename _ReturnType, typename... Args, std::size_t Capacity, bool Copyable>
+class inplaceFunc<_ReturnType(Args...), Capacity, Copyable>
+{
+public:
+    static_assert(Capacity >= sizeof(void*), "inplaceFunc capacity must be able to store a pointer");
+
+    /// @returns true if the given callable type is stored without allocating
+    template <typename Func>
+    static constexpr bool fitsInline = sizeof(Func) <= Capacity && alignof(Func) <= alignof(std::max_align_t) &&
+                                       std::is_nothrow_move_constructible_v<Func>;
+
+    inline inplaceFunc() noexcept = default;
+    inline inplaceFunc(std::nullptr_t) noexcept {}
+
+    template <typename Func, typename std::enable_if_t<!std::is_same_v<std::decay_t<Func>, inplaceFunc> &&
+                                                       std::is_invocable_r_v<_ReturnType, std::decay_t<Func>&, Args...>>* = nullptr>
+    inline inplaceFunc(Func&& function)
+    {
+        static_assert(!Copyable || std::is_copy_constructible_v<std::decay_t<Func>>, "A copyable inplaceFunc can only store copyable callables");
+        this->emplace<std::decay_t<Func>>(std::forward<Func>(function));
+    }
+
+    inline inplaceFunc(inplaceFunc&& other) noexcept
+    {
+        this->moveFrom(other);
+    }
+
+    inline inplaceFunc& operator=(inplaceFunc&& other) noexcept
+    {
+        if (this != &other)
+        {
+            this->reset();
+            this->moveFrom(other);
+        }
+        return *this;
+    }
+
+    inline inplaceFunc(const inplaceFunc& other) requires Copyable
+    {
+        this->copyFrom(other);
+    }
+
+    inline inplaceFunc& operator=(const inplaceFunc& other) requires Copyable
+    {
+        if (this != &other)
+        {
+            inplaceFunc temp(other);
+            *this = std::move(temp);
+        }
+        return *this;
+    }
+
+    template <typename Func, typename std::enable_if_t<!std::is_same_v<std::decay_t<Func>, inplaceFunc> &&
+                                                       std::is_invocable_r_v<_ReturnType, std::decay_t<Func>&, Args...>>* = nullptr>
+    inline inplaceFunc& operator=(Func&& function)
+    {
+        static_assert(!Copyable || std::is_copy_constructible_v<std::decay_t<Func>>, "A copyable inplaceFunc can only store copyable callables");
+        this->reset();
+        this->emplace<std::decay_t<Func>>(std::forward<Func>(function));
+        return *this;
+    }
+
+    inline inplaceFunc& operator=(std::nullptr_t) noexcept
+    {
+        this->reset();
+        return *this;
+    }
+
+    inline ~inplaceFunc()
+    {
+        this->reset();
+    }
+
+    /// @brief invokes the stored callable
+    /// @warning the callable must be valid
+    inline _ReturnType operator()(Args... args) const
+    {
+        return m_vtable->invoke(m_storage, std::forward<Args>(args)...);
+    }
+
+    /// @returns true if a callable is stored
+    inline explicit operator bool() const noexcept { return m_vtable != nullptr; }
+
+    /// @returns true if the stored callable is not heap allocated (true when empty)
+    inline bool isInline() const noexcept { return m_vtable == nullptr || m_vtable->isInline; }
+
+    /// @returns true if this can be copied
+    static constexpr bool isCopyable() noexcept { return Copyable; }
+
+    /// @returns the type of the stored callable, typeid(void) if empty
+    inline const std::type_info& target_type() const noexcept
+    {
+        return m_vtable == nullptr ? typeid(void) : m_vtable->type();
+    }
+
+    /// @brief destroys the stored callable
+    inline void reset() noexcept
+    {
+        if (m_vtable != nullptr)
+        {
+            m_vtable->destroy(m_storage);
+            m_vtable = nullptr;
+        }
+    }
+
+private:
+    /// @brief true if copying this copies the callable
+    template <typename Func>
+    static constexpr bool canCopy = Copyable && std::is_copy_constructible_v<Func>;
+
+    struct VTable
+    {
+        _ReturnType (*invoke)(void* storage, Args&&... args);
+        /// @brief move constructs into dest and destroys source
+        void (*move)(void* dest, void* source) noexcept;
+        /// @brief nullptr if this inplaceFunc is move only
+        void (*copy)(void* dest, const void* source);
+        void (*destroy)(void* storage) noexcept;
+        const std::type_info& (*type)() noexcept;
+        bool isInline;
+    };
+
+    template <typename Func>
+    struct InlineOps
+    {
+        static _ReturnType invoke(void* storage, Args&&... args)
+        {
+            return std::invoke(*static_cast<Func*>(storage), std::forward<Args>(args)...);
+        }
+        static void move(void* dest, void* source) noexcept
+        {
+            ::new (dest) Func(std::move(*static_cast<Func*>(source)));
+            static_cast<Func*>(source)->~Func();
+        }
+        static void copy(void* dest, const void* source)
+        {
+            if constexpr (canCopy<Func>)
+                ::new (dest) Func(*static_cast<const Func*>(source));
+        }
+        static void destroy(void* storage) noexcept
+        {
+            static_cast<Func*>(storage)->~Func();
+        }
+        static const std::type_info& type() noexcept { return typeid(Func); }
+
+        static constexpr VTable vtable = {&invoke, &move, canCopy<Func> ? &copy : nullptr, &destroy, &type, true};
+    };
+
+    /// @brief the buffer only stores a pointer to the callable
+    template <typename Func>
+    struct HeapOps
+    {
+        static Func*& get(void* storage) { return *static_cast<Func**>(storage); }
+
+        static _ReturnType invoke(void* storage, Args&&... args)
+        {
+            return std::invoke(*get(storage), std::forward<Args>(args)...);
+        }
+        static void move(void* dest, void* source) noexcept
+        {
+            ::new (dest) Func*(get(source));
+        }
+        static void copy(void* dest, const void* source)
+        {
+            if constexpr (canCopy<Func>)
+                ::new (dest) Func*(new Func(**static_cast<Func* const*>(source)));
+        }
+        static void destroy(void* storage) noexcept
+        {
+            delete get(storage);
+        }
+        static const std::type_info& type() noexcept { return typeid(Func); }
+
+        static constexpr VTable vtable = {&invoke, &move, canCopy<Func> ? &copy : nullptr, &destroy, &type, false};
+    };
+
+    template <typename Func, typename... FuncArgs>
+    void emplace(FuncArgs&&... funcArgs)
+    {
+        if constexpr (fitsInline<Func>)
+        {
+            ::new (static_cast<void*>(m_storage)) Func(std::forward<FuncArgs>(funcArgs)...);
+            m_vtable = &InlineOps<Func>::vtable;
+        }
+        else
+        {
+            #ifdef FUNC_HELPER_INPLACE_NO_HEAP
+            static_assert(fitsInline<Func>, "Callable is too big for this inplaceFunc, increase the capacity or FUNC_HELPER_INPLACE_CAPACITY");
+            #endif
+            ::new (static_cast<void*>(m_storage)) Func*(new Func(std::forward<FuncArgs>(funcArgs)...));
+            m_vtable = &HeapOps<Func>::vtable;
+        }
+    }
+
+    inline void moveFrom(inplaceFunc& other) noexcept
+    {
+        if (other.m_vtable != nullptr)
+        {
+            other.m_vtable->move(m_storage, other.m_storage);
+            m_vtable = other.m_vtable;
+            other.m_vtable = nullptr;
+        }
+    }
+
+    inline void copyFrom(const inplaceFunc& other)
+    {
+        if (other.m_vtable != nullptr)
+        {
+            other.m_vtable->copy(m_storage, other.m_storage);
+            m_vtable = other.m_vtable;
+        }
+    }
+
+    /// @note mutable so callables with non const call operators can be called from a const inplaceFunc (same as std::function)
+    alignas(std::max_align_t) mutable unsigned char m_storage[Capacity];
+    const VTable* m_vtable = nullptr;
+};
+
+}
+
+#endif // INPLACE_FUNC_H
@@ -6,20 +6,69 @@
 #include <string>
 #include <fstream>
 #include <map>
+#include <memory>
+#include <chrono>
 #include <cstdint>
+#include <vector>
+#include <iosfwd>
+#include <string_view>
+#include <type_traits>
+#include <atomic>
+#include <algorithm>
 
 /*
 TODO list:
-    - Logs are created per launch
-    - Logs are removed once a memory limit is passed
-    - Log folder can be set during runtime 
-        - No logs will be moved just the new logs location
-    - opt: Memory limit can be set and changed during runtime?
     - opt: ZIP Logs?
 */
 
 #define GET_FUNCTION_INFO() __FILE__ + ':' + std::to_string(__LINE__) + " " + __PRETTY_FUNCTION__
 
+/// @brief logs less severe than this are removed at compile time when using the LOG macros (severity from least to most: Debug, Info, Warning, Error, Fatal)
+/// @note can be defined before including to change it, Example: #define LOG_MIN_LEVEL Log::Type::Warning
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL Log::Type::Debug
+#endif
+
+/// @brief adds a log only if its type is enabled, the message is not evaluated otherwise
+/// @note the log type has to be known at compile time so disabled types are not compiled in
+/// @note Example: LOG(Log::Type::Debug, "Loaded " + std::to_string(count) + " items");
+#define LOG(logType, message) do { \
+    if constexpr (Log::isCompiledIn(logType)) \
+        if (Log::isEnabled(logType)) \
+            Log::add(logType, message); \
+} while (false)
+
+#define LOG_DEBUG(message) LOG(Log::Type::Debug, message)
+#define LOG_INFO(message) LOG(Log::Type::Info, message)
+#define LOG_WARNING(message) LOG(Log::Type::Warning, message)
+#define LOG_ERROR(message) LOG(Log::Type::Error, message)
+#define LOG_FATAL(message) LOG(Log::Type::Fatal, message)
+
+/// @brief same as LOG but this call site adds at most "perSecond" logs a second (with bursts of up to "burst" logs), the rest are dropped
+/// @note the message is not evaluated for dropped logs, the next log that is added says how many where dropped
+/// @note Example: LOG_RATE_LIMITED(Log::Type::Warning, 10, 20, "Packet from unknown client " + address);
+#define LOG_RATE_LIMITED(logType, perSecond, burst, message) do { \
+    if constexpr (Log::isCompiledIn(logType)) \
+    { \
+        static Log::RateLimiter _logRateLimiter(perSecond, burst); \
+        if (Log::isEnabled(logType) && _logRateLimiter.tryAcquire()) \
+            Log::add(logType, Log::RateLimiter::withSuppressed(message, _logRateLimiter.takeSuppressed())); \
+    } \
+} while (false)
+
+/// @brief adds a log to the binary log, the format is registered once per call site and each log only stores the arguments
+/// @note "{}" in the format is replaced by the next argument when the binary log is decoded
+/// @note the arguments are only evaluated if the log type is enabled, same as LOG
+/// @note Example: LOG_BINARY(Log::Type::Info, "Player {} moved to {}, {}", id, x, y);
+#define LOG_BINARY(logType, format, ...) do { \
+    if constexpr (Log::isCompiledIn(logType)) \
+    { \
+        static const Log::FormatID _logFormatID = Log::registerFormat(logType, format); \
+        if (Log::isEnabled(logType)) \
+            Log::addBinary(_logFormatID __VA_OPT__(,) __VA_ARGS__); \
+    } \
+} while (false)
+
 class Log
 {
 public:
@@ -32,25 +81,304 @@ public:
         Fatal = 4
     };
 
+    /// @brief what happens to a log added in async mode when the buffer is full
+    enum class OverflowPolicy : int8_t
+    {
+        /// @brief waits until the background thread makes space
+        Block = 0,
+        /// @brief the log is thrown away
+        Drop = 1,
+        /// @brief the log is thrown away and counted, a warning with the count is written once there is space again
+        DropAndCount = 2
+    };
+
+    /// @brief identifies a format registered for binary logs
+    using FormatID = uint32_t;
+
+    /// @brief a token bucket that allows a max rate with short bursts, used by LOG_RATE_LIMITED
+    /// @note can be used from any thread without locking
+    class RateLimiter
+    {
+    public:
+        /// @param perSecond the number of tokens added back every second
+        /// @param burst the max number of tokens that can be saved up
+        inline RateLimiter(double perSecond, size_t burst) : 
+            m_interval(perSecond <= 0 ? INT64_MAX : (int64_t)(1'000'000'000.0 / perSecond)),
+            m_tolerance(perSecond <= 0 ? 0 : m_interval * (int64_t)burst) {}
+
+        /// @brief takes a token if there is one
+        /// @returns false if there where no tokens, the call is counted as suppressed
+        inline bool tryAcquire()
+        {
+            if (m_tolerance == 0)
+            {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            // storing when the bucket will be full again instead of the token count so this is a single value
+            int64_t full = m_full.load(std::memory_order_relaxed);
+            int64_t newFull;
+            do
+            {
+                newFull = std::max(full, now) + m_interval;
+                if (newFull - now > m_tolerance)
+                {
+                    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            } while (!m_full.compare_exchange_weak(full, newFull, std::memory_order_relaxed));
+            return true;
+        }
+        /// @returns the number of calls that where suppressed since the last call to this
+        inline size_t takeSuppressed() { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+
+        /// @returns the message with the number of suppressed logs added if there where any
+        inline static std::string withSuppressed(std::string message, size_t suppressed)
+        {
+            if (suppressed != 0)
+                message += " (" + std::to_string(suppressed) + " similar logs where suppressed)";
+            return message;
+        }
+
+    private:
+        const int64_t m_interval;
+        const int64_t m_tolerance;
+        std::atomic<int64_t> m_full = 0;
+        std::atomic<size_t> m_suppressed = 0;
+    };
+
+    /// @returns how severe the log type is, higher is more severe
+    inline static constexpr int getSeverity(Log::Type logType)
+    {
+        switch (logType)
+        {
+        case Log::Type::Debug: return 0;
+        case Log::Type::Info: return 1;
+        case Log::Type::Warning: return 2;
+        case Log::Type::Error: return 3;
+        case Log::Type::Fatal: return 4;
+        }
+        return 4;
+    }
+    /// @returns true if the type is at least as severe as LOG_MIN_LEVEL
+    inline static constexpr bool isCompiledIn(Log::Type logType) { return getSeverity(logType) >= getSeverity(LOG_MIN_LEVEL); }
+    /// @brief logs less severe than this are ignored by "add" and the LOG macros (Debug by default so everything is logged)
+    /// @note can be changed from any thread
+    static void setMinLevel(Log::Type logType);
+    static Log::Type getMinLevel();
+    /// @returns true if logs of this type are currently logged
+    inline static bool isEnabled(Log::Type logType) { return getSeverity(logType) >= minSeverity.load(std::memory_order_relaxed); }
+
     /// @brief directory is based on the working directory
+    /// @note logs after this go to a new file in the new folder, old logs are not moved
     static void setLogFolder(std::string path = "Logs");
     static std::string getLogFolder();
+    /// @brief a new log file is started once the current one (text and binary together) is at least this many bytes, 0 for no limit (the default)
+    /// @note on linux new files have this much space preallocated so writes do not have to grow the file, the space that is not used is given back when the file is closed
+    static void setMaxFileSize(uintmax_t bytes);
+    static uintmax_t getMaxFileSize();
+    /// @brief the oldest log files in the log folder are deleted once all of them together are more than this many bytes, 0 for no limit (the default)
+    /// @note the current log files are never deleted
+    /// @note the old logs and there sizes are saved to "Logs.index" in the log folder when the program exits so the next launch does not have to look at every file
+    static void setMaxFolderSize(uintmax_t bytes);
+    static uintmax_t getMaxFolderSize();
     static void setPrintToCout(bool printToCout);
     static bool getPrintToCout();
+    /// @brief if true the time of each log includes microseconds after the seconds (false by default so lines have the same layout as std::ctime)
+    /// @note can be changed from any thread
+    static void setPrintMicroseconds(bool printMicroseconds);
+    static bool getPrintMicroseconds();
+    /// @brief if true each log has a column with the time since the program started (from a monotonic clock in nanoseconds) after the wall clock time (false by default)
+    /// @note this is the same time as "getMonotonicTime" so logs can be lined up with other measurements (e.g. timer::Stopwatch laps)
+    /// @note binary logs do not store this so it is not in their decoded text
+    static void setPrintMonotonicTime(bool printMonotonicTime);
+    static bool getPrintMonotonicTime();
+    /// @returns the time since the program started from a monotonic clock, the same time that is printed with each log if "setPrintMonotonicTime" is true
+    static std::chrono::nanoseconds getMonotonicTime();
+    /// @returns the path of the current log file, empty if no log has been added yet
+    static std::string getFilePath();
 
+    /// @note can be called from any thread, lines from different threads are never mixed
+    /// @note the message is built even if the type is disabled, use the LOG macros to skip that
     static void add(Log::Type logType, std::string message);
 
+    /// @brief when async is true every thread pushes its logs into its own ring buffer and a background thread merges them (by time) and writes them to the file in batches
+    /// @param bufferSize the max number of logs waiting to be written per thread (rounded up to a power of 2)
+    /// @note if already async the buffers are drained and the background thread is restarted with the new settings
+    /// @note logs are only sorted by time within each batch that is written, logs from different threads that are added at almost the same time can be out of order
+    /// @warning should not be called while other threads are adding logs
+    static void setAsync(bool async, size_t bufferSize = 1024, OverflowPolicy policy = OverflowPolicy::Block);
+    static bool isAsync();
+    /// @brief waits until every log added before this call is written to the file
+    static void flush();
+    /// @returns the number of logs that where dropped because an async buffer was full
+    static size_t getDroppedCount();
+
+    /// @brief when on, text logs are also copied into a memory mapped ring file (FlightRecorder.ring in the log folder) as well as being written to the log file as normal
+    /// @param size the size of the ring file in bytes, only the newest logs that fit are kept
+    /// @note copying a log into the ring does not make any system calls, the os saves the ring to the file even if the program crashes
+    /// @note when turned off or when the program exits the ring is left in place and marked as closed, its logs are already in the log file so it is not drained
+    /// @note when turned on, if the last ring was not closed (the program crashed) its logs are added to the log file since the newest ones could be missing from it
+    /// @note binary logs are not added to the ring
+    /// @warning should not be called while other threads are adding logs
+    static void setFlightRecorder(bool enabled, size_t size = 1024 * 1024);
+    static bool isFlightRecorder();
+    static std::string getFlightRecorderPath();
+    /// @brief writes the lines in a flight recorder ring file from oldest to newest
+    /// @returns false if the input is not a flight recorder ring file
+    static bool recoverFlightRecorder(std::istream& input, std::ostream& output);
+
+    /// @brief registers a format for binary logs, normally done once per call site by LOG_BINARY
+    /// @param format "{}" is replaced by the next argument when decoding
+    /// @note can be called from any thread
+    static FormatID registerFormat(Log::Type logType, std::string format);
+    /// @brief adds a log to the binary log file (the text log file path ending in .blog instead)
+    /// @note the arguments are stored as raw bytes and only formatted when decoding, so this is much cheaper than "add" and takes much less space
+    /// @note supports arithmetic types, chars, bools, and strings (std::string, std::string_view, const char*)
+    /// @note follows the same async settings as "add" but binary logs are never printed to cout
+    template <typename... Args>
+    static void addBinary(FormatID format, const Args&... args);
+    /// @returns the path of the current binary log file, empty if no binary log has been added yet
+    static std::string getBinaryFilePath();
+    /// @brief converts a binary log into the same text that "add" would have written
+    /// @returns false if the input is not a binary log or is cut off (everything before that is still written)
+    static bool decodeBinary(std::istream& input, std::ostream& output);
+
 protected:
     Log();
 
+    /// @brief the type of an argument in a binary log, each argument is stored as the type followed by its bytes
+    /// @note strings are stored as a uint32 length followed by the characters
+    enum class ArgType : uint8_t
+    {
+        Int8, Int16, Int32, Int64,
+        UInt8, UInt16, UInt32, UInt64,
+        Float, Double, Bool, Char, String
+    };
+
+    template <typename T>
+    static void encodeArg(std::string& data, const T& value);
+    /// @brief adds a binary log with the already encoded arguments
+    static void addEncoded(FormatID format, std::string&& args);
+    /// @brief appends the binary log (after the format if the binary file does not have it yet) to the data
+    /// @note the file lock must be held
+    static void appendBinary(std::string& data, FormatID format, std::chrono::system_clock::time_point time, const std::string& args);
+    /// @brief writes the data to the binary log file and flushes it, the file is opened if needed
+    /// @note the file lock must be held
+    static void writeBinary(const std::string& data);
+
+    /// @brief finds the old logs in the log folder and the index of the next file for today
+    /// @note uses the index saved by saveIndex instead of looking at every file if no files where added or removed since it was saved
+    static void scanFolder();
+    /// @brief saves the old logs and there sizes in the log folder so the next scan does not have to look at every file
+    /// @note the file lock must be held, does nothing if the sizes of the old logs are not known
+    static void saveIndex();
+    /// @brief opens the log file for the current date and index in the log folder
+    static void openFile();
+    /// @brief opens the binary log file for the current log file
+    static void openBinaryFile();
+    /// @param keep if true the files are kept track of so they can be deleted once the folder is too big
+    static void closeFiles(bool keep);
+    /// @brief opens the log file if needed, starts a new one if the current one is too big, and deletes old logs if the folder is too big
+    /// @note the file lock must be held
+    static void prepareFile();
+    /// @brief when a log was added
+    struct Timestamp
+    {
+        std::chrono::system_clock::time_point wall;
+        /// @brief since the program started, negative if not known
+        std::chrono::nanoseconds monotonic;
+    };
+    /// @brief only reads the monotonic clock, the wall clock time is the monotonic time plus an offset that is updated once a second
+    static Timestamp now();
+    /// @brief appends the formatted log line to the given string
+    /// @note the time text is only remade when the second changes (per thread)
+    static void formatLine(std::string& line, Log::Type logType, const Timestamp& time, const std::string& message);
+    /// @brief writes the lines to the log file (and cout if printing to cout) and flushes them
+    /// @note the file lock must be held
+    static void write(const std::string& lines);
+
     static std::string getCurrentTime();
     static std::string getCurrentDate();
 
 private:
+    class AsyncWriter;
+    class FileCloser;
+    class FlightRecorder;
+
     static bool printToCout;
+    inline static std::atomic<bool> printMicroseconds = false;
+    inline static std::atomic<bool> printMonotonicTime = false;
     static std::string LogFolder;
     static std::ofstream file;
+    static std::string filePath;
+    static std::ofstream binaryFile;
+    static std::string binaryFilePath;
+    /// @brief the formats that have been written to the binary file, indexed by id
+    static std::vector<bool> writtenFormats;
     static const std::map<const Log::Type, const std::string> LogDictionary;
+    static FileCloser fileCloser;
+    /// @brief the severity of the min level
+    inline static std::atomic<int> minSeverity = 0;
+    /// @brief nullptr when not async
+    static std::unique_ptr<AsyncWriter> asyncWriter;
+    /// @brief nullptr when not recording
+    static std::unique_ptr<FlightRecorder> flightRecorder;
 };
 
+template <typename T>
+void Log::encodeArg(std::string& data, const T& value)
+{
+    auto append = [&data](ArgType type, const void* bytes, size_t size){
+        data += (char)type;
+        data.append(static_cast<const char*>(bytes), size);
+    };
+
+    if constexpr (std::is_same_v<T, bool>)
+        append(ArgType::Bool, &value, 1);
+    else if constexpr (std::is_same_v<T, char>)
+        append(ArgType::Char, &value, 1);
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        if constexpr (sizeof(T) <= sizeof(float))
+        {
+            const float temp = value;
+            append(ArgType::Float, &temp, sizeof(temp));
+        }
+        else
+        {
+            const double temp = value;
+            append(ArgType::Double, &temp, sizeof(temp));
+        }
+    }
+    else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+    {
+        using Integer = std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>, std::type_identity<T>>::type;
+        // the type values are in size order so the size picks the type
+        constexpr uint8_t sizeIndex = sizeof(Integer) == 1 ? 0 : sizeof(Integer) == 2 ? 1 : sizeof(Integer) == 4 ? 2 : 3;
+        constexpr ArgType type = ArgType((std::is_signed_v<Integer> ? (uint8_t)ArgType::Int8 : (uint8_t)ArgType::UInt8) + sizeIndex);
+        const Integer temp = static_cast<Integer>(value);
+        append(type, &temp, sizeof(temp));
+    }
+    else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+    {
+        const std::string_view string = value;
+        const uint32_t size = (uint32_t)string.size();
+        append(ArgType::String, &size, sizeof(size));
+        data.append(string.data(), size);
+    }
+    else
+        static_assert(!sizeof(T), "Binary logs only support arithmetic types, enums, and strings");
+}
+
+template <typename... Args>
+void Log::addBinary(FormatID format, const Args&... args)
+{
+    std::string data;
+    (Log::encodeArg(data, args), ...);
+    Log::addEncoded(format, std::move(data));
+}
+
 #endif
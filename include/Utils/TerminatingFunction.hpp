@@ -52,22 +52,22 @@ public:
     /// @note if the function is already added it will be added again
     /// @note when a function is removed or over its limit data will set "isForceStop" to true
     /// @warning The function will only be added if it is valid
-    /// @returns the function typeid is "" if function is not valid
-    static std::string Add(funcHelper::funcDynamic<Data*> function, float maxTime = std::numeric_limits<float>::infinity());
+    /// @returns the id of the function (funcHelper::INVALID_FUNC_ID if the function is not valid)
+    static funcHelper::funcID Add(funcHelper::funcDynamic<Data*> function, float maxTime = std::numeric_limits<float>::infinity());
     /// @brief clears all terminating functions from the list 
     /// @note this gives warning to all functions before clearing (i.e. runs once more before clearing)
     static void clear();
     /// @brief erases the given function from the terminating functions list IF there is one in the list
     /// @note this will still call the function one more time so it has warning of ending
-    /// @note removes all functions with the same functionTypeid
-    static void remove(const std::string& functionTypeid);
+    /// @note removes all functions with the same id
+    static void remove(funcHelper::funcID functionID);
     /// @brief erases the given function from the terminating functions list IF there is one in the list
-    /// @note removes all functions with the same functionTypeid
+    /// @note removes all functions with the same id
     /// @warning bypasses the final call which gives warning of ending
-    static void forceRemove(const std::string& functionTypeid);
-    /// @brief requests to stop the given function type id
+    static void forceRemove(funcHelper::funcID functionID);
+    /// @brief requests to stop the function with the given id
     /// @returns true if it was requested and false if function not found
-    static bool requestStop(const std::string& functionTypeid);
+    static bool requestStop(funcHelper::funcID functionID);
 
     /// @brief gets the string data from ever terminating function at the moment
     /// @return a list where each item is a list of: function name, total time running, max run time
@@ -76,7 +76,7 @@ public:
 protected:
     struct _tFunc
     {
-        _tFunc(funcHelper::funcDynamic<Data*> func, float maxTime) : m_func(func), m_maxTime(maxTime) {}
+        _tFunc(funcHelper::funcDynamic<Data*>&& func, float maxTime) : m_func(std::move(func)), m_maxTime(maxTime) {}
 
         funcHelper::funcDynamic<Data*> m_func;
         float m_totalTime = 0.f;
@@ -84,9 +84,9 @@ protected:
         bool m_requestStop = false;
 
         bool operator== (const _tFunc& tFunc) const;
-        bool operator== (const std::string& id) const;
+        bool operator== (funcHelper::funcID id) const;
         bool operator< (const _tFunc& tFunc) const;
-        bool operator< (const std::string& id) const;
+        bool operator< (funcHelper::funcID id) const;
         /// @brief removes everything before "setFunction"
         /// @param typeID the typeID of the function
         /// @returns shortened id
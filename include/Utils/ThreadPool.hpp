@@ -0,0 +1,214 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+
+#include "InplaceFunc.hpp"
+
+/// @brief Pool of worker threads that run tasks
+/// @note every worker has its own queue of tasks, workers take the newest task from there own queue and steal the oldest task from other queues when they run out
+/// @note threads waiting on work from the pool (parallelFor) run queued tasks while waiting so nested calls can not deadlock
+class ThreadPool
+{
+public:
+    using Task = funcHelper::inplaceFunc<void()>;
+
+    /// @brief stats of a pool since it was created or since "resetStats"
+    struct Stats
+    {
+        /// @brief number of tasks currently waiting to be run
+        size_t depth = 0;
+        /// @brief max number of tasks that where waiting at once
+        size_t maxDepth = 0;
+        /// @brief number of tasks that where submitted
+        size_t submitted = 0;
+        /// @brief number of tasks that where started
+        size_t started = 0;
+        /// @brief average ns between a task being submitted and it starting
+        double averageLatency = 0;
+        /// @brief max ns between a task being submitted and it starting
+        uint64_t maxLatency = 0;
+    };
+
+    /// @param threads number of worker threads, 0 uses one less than the number of hardware threads (at least 1) since the thread waiting on the work also runs tasks
+    explicit ThreadPool(size_t threads = 0);
+    /// @note waits for all queued tasks to finish
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// @returns the pool shared by everything that does not need its own
+    static ThreadPool& getShared();
+    /// @brief sets the number of worker threads the shared pool is created with (same as the constructor, 0 is the default)
+    /// @note only works before the shared pool is first used
+    /// @returns false if the shared pool was already created
+    static bool setSharedThreadCount(size_t threads);
+
+    /// @brief queues the task to be run by one of the workers
+    /// @note tasks submitted from a worker are added to that workers queue
+    /// @warning tasks must not throw, use parallelFor to get exceptions back
+    void submit(Task&& task);
+
+    /// @brief calls func(index) for every index in [0, count) spread over the workers and this thread
+    /// @param grainSize number of indices that are taken at a time, larger is better when func is cheap
+    /// @note returns once every call is finished, if a call throws the first exception is rethrown here (the rest of the indices may not be called)
+    template <typename Func>
+    void parallelFor(size_t count, size_t grainSize, const Func& func);
+
+    /// @brief runs one queued task on this thread
+    /// @returns true if a task was run
+    bool runPendingTask();
+    /// @brief runs queued tasks on this thread until done returns true, sleeping while there are none
+    /// @note whatever makes done return true must call "notifyWaiters" after so a sleeping thread wakes up
+    template <typename Func>
+    void waitUntil(const Func& done);
+    /// @brief wakes the threads in "waitUntil" so they check if they are done
+    void notifyWaiters();
+
+    inline size_t getThreadCount() const { return m_workers.size(); }
+
+    /// @note can be called from any thread
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    struct QueuedTask
+    {
+        Task task;
+        /// @brief steady clock time in ns of when the task was submitted
+        uint64_t queuedTime;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex lock;
+        std::deque<QueuedTask> tasks;
+    };
+
+    /// @brief takes the newest task from the given queue
+    bool popTask(size_t queue, QueuedTask& task);
+    /// @brief takes the oldest task from any queue other than the given one
+    bool stealTask(size_t thief, QueuedTask& task);
+    /// @brief records how long the task waited then runs it
+    void runTask(QueuedTask& task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    /// @brief used to spread tasks submitted from other threads over the queues
+    std::atomic<size_t> m_nextQueue = 0;
+    std::atomic<size_t> m_queuedTasks = 0;
+
+    std::mutex m_sleepLock;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    /// @brief threads in "waitUntil", woken when a task is submitted or by "notifyWaiters"
+    std::condition_variable m_waiterWake;
+    /// @note only changed with the sleep lock held
+    size_t m_waiting = 0;
+
+    std::atomic<size_t> m_maxDepth = 0;
+    std::atomic<size_t> m_submitted = 0;
+    std::atomic<size_t> m_started = 0;
+    std::atomic<uint64_t> m_totalLatency = 0;
+    std::atomic<uint64_t> m_maxLatency = 0;
+
+    /// @brief the pool and queue index of the worker running on this thread (nullptr if this thread is not a worker)
+    static thread_local ThreadPool* m_currentPool;
+    static thread_local size_t m_currentIndex;
+};
+
+template <typename Func>
+void ThreadPool::parallelFor(size_t count, size_t grainSize, const Func& func)
+{
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t chunks = (count + grainSize - 1) / grainSize;
+    if (chunks <= 1 || m_workers.empty())
+    {
+        for (size_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    struct Shared
+    {
+        std::atomic<size_t> nextChunk = 0;
+        std::atomic<size_t> runningHelpers = 0;
+        std::atomic<bool> failed = false;
+        std::mutex exceptionLock;
+        std::exception_ptr exception;
+    } shared;
+
+    // every thread keeps taking chunks until there are none left so uneven chunks balance out
+    auto runChunks = [&shared, &func, chunks, count, grainSize]()
+    {
+        size_t chunk;
+        while ((chunk = shared.nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunks)
+        {
+            if (shared.failed.load(std::memory_order_relaxed))
+                continue;
+            try
+            {
+                for (size_t i = chunk * grainSize, end = std::min(count, i + grainSize); i < end; i++)
+                    func(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(shared.exceptionLock);
+                if (!shared.exception)
+                    shared.exception = std::current_exception();
+                shared.failed = true;
+            }
+        }
+    };
+
+    const size_t helpers = std::min(chunks - 1, m_workers.size());
+    shared.runningHelpers.store(helpers, std::memory_order_relaxed);
+    for (size_t i = 0; i < helpers; i++)
+    {
+        submit([&shared, &runChunks]{
+            runChunks();
+            shared.runningHelpers.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    runChunks();
+    // the helpers reference this stack frame so all of them have to finish (they may not have even started yet)
+    while (shared.runningHelpers.load(std::memory_order_acquire) != 0)
+    {
+        if (!runPendingTask())
+            std::this_thread::yield();
+    }
+
+    if (shared.exception)
+        std::rethrow_exception(shared.exception);
+}
+
+template <typename Func>
+void ThreadPool::waitUntil(const Func& done)
+{
+    while (!done())
+    {
+        if (runPendingTask())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepLock);
+        ++m_waiting;
+        m_waiterWake.wait(lock, [this, &done]{ return done() || m_queuedTasks.load(std::memory_order_acquire) > 0; });
+        --m_waiting;
+    }
+}
+
+#endif // THREAD_POOL_H
@@ -5,35 +5,326 @@
 
 #include <functional>
 #include <utility>
-#include <deque>
+#include <tuple>
 #include <cassert>
-
+#include <cstdint>
+#include <atomic>
+#include <type_traits>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <vector>
+#include <exception>
+#include <stdexcept>
+#include <chrono>
+#include <list>
+#include <unordered_map>
+
+#include "InplaceFunc.hpp"
+#include "ThreadPool.hpp"
 
 namespace funcHelper
 {
-template<typename _ReturnType = void>
+/// @brief how dynamic parameters are given to functions, by const reference unless the parameter type is already a reference
+template <typename T>
+using dynamicParam = std::conditional_t<std::is_lvalue_reference_v<T>, T, const std::remove_cvref_t<T>&>;
+
+/// @brief returned by "dynamicParamCount" when the function can not be called with the bound arguments
+static constexpr std::size_t INVALID_PARAM_COUNT = SIZE_MAX;
+
+template <typename _ReturnType, typename Func, typename BoundArgs, typename Params, typename Indices>
+struct isInvocableWithParams;
+
+/// @brief true if the function can be called with the bound arguments followed by the dynamic parameters at the given indices
+/// @note the function and bound arguments are given as references to the stored (decayed) copies so mutable lambdas and non const callables work
+template <typename _ReturnType, typename Func, typename... BoundArgs, typename Params, std::size_t... I>
+struct isInvocableWithParams<_ReturnType, Func, std::tuple<BoundArgs...>, Params, std::index_sequence<I...>>
+    : std::is_invocable_r<_ReturnType, std::decay_t<Func>&, std::decay_t<BoundArgs>&..., std::tuple_element_t<I, Params>...> {};
+
+/// @brief true if the function can be called with the bound arguments (as they are stored)
+template <typename _ReturnType, typename Func, typename... BoundArgs>
+static constexpr bool isBindable = std::is_invocable_r_v<_ReturnType, std::decay_t<Func>&, std::decay_t<BoundArgs>&...>;
+
+/// @brief true if the function and bound arguments can be stored in a func that is copyable or not
+template <bool Copyable, typename Func, typename... BoundArgs>
+static constexpr bool isStorable = !Copyable || (std::is_copy_constructible_v<std::decay_t<Func>> && (std::is_copy_constructible_v<std::decay_t<BoundArgs>> && ...));
+
+/// @returns the number of dynamic parameters (from the front) that the function takes after the bound arguments
+/// @note takes as many as possible, INVALID_PARAM_COUNT if the function can not be called with any number of them
+/// @tparam BoundArgs tuple of the bound argument types
+/// @tparam Params tuple of the dynamic parameter types
+template <typename _ReturnType, typename Func, typename BoundArgs, typename Params, std::size_t Count = std::tuple_size_v<Params>>
+constexpr std::size_t dynamicParamCount()
+{
+    if constexpr (isInvocableWithParams<_ReturnType, Func, BoundArgs, Params, std::make_index_sequence<Count>>::value)
+        return Count;
+    else if constexpr (Count == 0)
+        return INVALID_PARAM_COUNT;
+    else
+        return dynamicParamCount<_ReturnType, Func, BoundArgs, Params, Count - 1>();
+}
+
+/// @returns a function that takes a pointer to the Params of an invoke and calls the given function with the bound arguments followed by the parameters it takes
+/// @note the function type is known inside of the returned lambda so the call is inlined, the only indirection is the call to the lambda itself
+/// @note the function and bound arguments are moved into the returned lambda when given as rvalues (so they can be move only) and copied otherwise
+/// @note the returned lambda is mutable so the stored function and bound arguments can be changed by the call (i.e. mutable lambdas)
+/// @tparam Params the tuple of references that will be given to the returned function (not used when the function takes no dynamic parameters)
+template <typename _ReturnType, typename Params, typename Func, typename... BoundArgs>
+inline auto bindDynamic(Func&& function, BoundArgs&&... args)
+{
+    constexpr std::size_t count = dynamicParamCount<_ReturnType, Func, std::tuple<BoundArgs...>, Params>();
+    static_assert(count != INVALID_PARAM_COUNT, "The function can not be called with the bound arguments followed by the dynamic parameters");
+
+    return [function = std::forward<Func>(function), ...args = std::forward<BoundArgs>(args)](const void* params) mutable -> _ReturnType {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) -> _ReturnType {
+            assert((count == 0 || params != nullptr) && "Dynamic functions must be invoked with their parameters");
+            if constexpr (std::is_void_v<_ReturnType>)
+                std::invoke(function, args..., std::get<I>(*static_cast<const Params*>(params))...);
+            else
+                return std::invoke(function, args..., std::get<I>(*static_cast<const Params*>(params))...);
+        }(std::make_index_sequence<count>());
+    };
+}
+
+/// @brief identifies the function set in a func, copies of a func have the same id
+using funcID = std::uint64_t;
+/// @brief the id of a func that does not have a function set
+static constexpr funcID INVALID_FUNC_ID = 0;
+
+/// @returns an id that has not been given to any other function
+inline funcID newFuncID()
+{
+    static std::atomic<funcID> nextID = INVALID_FUNC_ID + 1;
+    return nextID.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// @brief lets async invokes be cancelled before they start
+/// @note copies share the same state so cancelling one cancels all of them
+/// @note functions that are already running are not stopped but can check "isCancelled" themselves if they have a copy of the token
+class cancelToken
+{
+public:
+    inline cancelToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    inline void cancel() { m_cancelled->store(true, std::memory_order_release); }
+    inline bool isCancelled() const { return m_cancelled->load(std::memory_order_acquire); }
+
+private:
+    template <typename> friend class asyncResult;
+    template <typename, bool> friend class func;
+    template <bool, typename...> friend class basicFuncDynamic;
+
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+/// @brief thrown by "asyncResult::get" when the invoke was cancelled before it started
+class cancelledError : public std::runtime_error
+{
+public:
+    inline cancelledError() : std::runtime_error("The async invoke was cancelled before it started") {}
+};
+
+/// @brief the shared state of an asyncResult
+/// @note dont use this directly, use asyncResult
+template <typename _ReturnType>
+struct asyncState
+{
+    enum class Status
+    {
+        Pending,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    inline asyncState(ThreadPool* pool, std::shared_ptr<std::atomic<bool>> cancelled) : pool(pool), cancelled(std::move(cancelled)) {}
+
+    /// @brief calls the function and stores its result or exception, unless this was cancelled
+    template <typename Func>
+    void run(Func&& function)
+    {
+        if (cancelled != nullptr && cancelled->load(std::memory_order_acquire))
+        {
+            this->finish(Status::Cancelled);
+            return;
+        }
+
+        try
+        {
+            if constexpr (std::is_void_v<_ReturnType>)
+                function();
+            else
+                value.emplace(function());
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+            this->finish(Status::Failed);
+            return;
+        }
+        this->finish(Status::Finished);
+    }
+
+    /// @brief sets the status, wakes any waiting threads, and calls the continuations
+    void finish(Status finalStatus)
+    {
+        std::vector<inplaceFunc<void()>> toCall;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            status.store(finalStatus, std::memory_order_release);
+            toCall.swap(continuations);
+        }
+        pool->notifyWaiters();
+        for (inplaceFunc<void()>& continuation: toCall)
+            continuation();
+    }
+
+    /// @brief calls the function once this is finished (right away if it already is)
+    void onFinished(inplaceFunc<void()>&& function)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (status.load(std::memory_order_relaxed) == Status::Pending)
+            {
+                continuations.emplace_back(std::move(function));
+                return;
+            }
+        }
+        function();
+    }
+
+    ThreadPool* pool;
+    /// @brief nullptr if the invoke can not be cancelled
+    std::shared_ptr<std::atomic<bool>> cancelled;
+
+    /// @brief guards the continuations
+    std::mutex lock;
+    std::atomic<Status> status = Status::Pending;
+    std::optional<std::conditional_t<std::is_void_v<_ReturnType>, char, _ReturnType>> value;
+    std::exception_ptr exception;
+    /// @brief called once finished
+    std::vector<inplaceFunc<void()>> continuations;
+};
+
+/// @brief the result of an async invoke that can be waited on or chained with "then"
+/// @note copies share the same result
+template <typename _ReturnType>
+class asyncResult
+{
+public:
+    using State = asyncState<_ReturnType>;
+
+    /// @note a default constructed result is not valid
+    inline asyncResult() = default;
+    inline explicit asyncResult(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+
+    /// @returns true if this is the result of an invoke
+    /// @note every other function must only be called on a valid result
+    inline bool isValid() const { return m_state != nullptr; }
+    /// @returns true once the function finished, threw, or was cancelled
+    inline bool isReady() const 
+    { 
+        assert(("The result must be valid", this->isValid()));
+        return m_state->status.load(std::memory_order_acquire) != State::Status::Pending; 
+    }
+    /// @returns true if the invoke was cancelled before it started
+    inline bool isCancelled() const 
+    { 
+        assert(("The result must be valid", this->isValid()));
+        return m_state->status.load(std::memory_order_acquire) == State::Status::Cancelled; 
+    }
+
+    /// @brief waits until the result is ready
+    /// @note runs other tasks of the pool while waiting so waiting from inside of a task can not deadlock, sleeps when there are none
+    void wait() const
+    {
+        assert(("The result must be valid", this->isValid()));
+        m_state->pool->waitUntil([this]{ return this->isReady(); });
+    }
+
+    /// @brief waits until the result is ready
+    /// @note rethrows the exception if the function threw and throws cancelledError if it was cancelled
+    /// @returns a copy of the value returned by the function (copies of this result share the value so it can not be moved out)
+    _ReturnType get() const
+    {
+        this->wait();
+        if (m_state->status.load(std::memory_order_acquire) == State::Status::Failed)
+            std::rethrow_exception(m_state->exception);
+        if (this->isCancelled())
+            throw cancelledError();
+        if constexpr (!std::is_void_v<_ReturnType>)
+            return *m_state->value;
+    }
+
+    /// @brief calls the given function with the value (if there is one) on the same pool once this is finished
+    /// @note if this threw or was cancelled the function is not called and the returned result throws the same
+    /// @note cancelling the token this was invoked with also cancels the continuations that have not started yet
+    /// @returns the result of the given function
+    template <typename Func>
+    auto then(Func&& function) const
+    {
+        assert(("The result must be valid", this->isValid()));
+        using NextType = typename std::conditional_t<std::is_void_v<_ReturnType>, std::invoke_result<std::decay_t<Func>&>, 
+                                                     std::invoke_result<std::decay_t<Func>&, const std::conditional_t<std::is_void_v<_ReturnType>, char, _ReturnType>&>>::type;
+        auto next = std::make_shared<asyncState<NextType>>(m_state->pool, m_state->cancelled);
+
+        m_state->onFinished([parent = m_state, next, function = std::forward<Func>(function)]() mutable {
+            if (parent->status.load(std::memory_order_acquire) == State::Status::Failed)
+            {
+                next->exception = parent->exception;
+                next->finish(asyncState<NextType>::Status::Failed);
+                return;
+            }
+            if (parent->status.load(std::memory_order_acquire) == State::Status::Cancelled)
+            {
+                next->finish(asyncState<NextType>::Status::Cancelled);
+                return;
+            }
+
+            next->pool->submit([parent = std::move(parent), next, function = std::move(function)]() mutable {
+                next->run([&]() -> NextType {
+                    if constexpr (std::is_void_v<_ReturnType>)
+                        return function();
+                    else
+                        return function(static_cast<const _ReturnType&>(*parent->value));
+                });
+            });
+        });
+        return asyncResult<NextType>(std::move(next));
+    }
+
+private:
+    std::shared_ptr<State> m_state;
+};
+
+/// @tparam Copyable if false the func is move only and can hold move only functions and bound arguments (see funcMoveOnly)
+template<typename _ReturnType = void, bool Copyable = true>
 class func
 {
 public:
     func() = default;
     ~func() = default;
+    func(const func&) = default;
+    func& operator=(const func&) = default;
+    func(func&&) noexcept = default;
+    func& operator=(func&&) noexcept = default;
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<_ReturnType(const BoundArgs&...)>>::value>* = nullptr>
-    inline func(const Func& _function, const BoundArgs&... args)
+    /// @note the function and bound arguments are moved in when given as rvalues and copied otherwise
+    /// @note copyable funcs only take copyable functions and bound arguments, use a move only func for the others
+    template<typename Func, typename... BoundArgs, typename std::enable_if_t<!std::is_same_v<std::decay_t<Func>, func> && isBindable<_ReturnType, Func, BoundArgs...> &&
+                                                                             isStorable<Copyable, Func, BoundArgs...>>* = nullptr>
+    inline func(Func&& _function, BoundArgs&&... args)
     { 
-        this->setFunction(_function, args...); 
+        this->setFunction(std::forward<Func>(_function), std::forward<BoundArgs>(args)...); 
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<_ReturnType(const BoundArgs&...)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
+    /// @note the function and bound arguments are moved in when given as rvalues and copied otherwise
+    /// @note copyable funcs only take copyable functions and bound arguments, use a move only func for the others
+    template<typename Func, typename... BoundArgs, typename std::enable_if_t<isBindable<_ReturnType, Func, BoundArgs...> && isStorable<Copyable, Func, BoundArgs...>>* = nullptr>
+    inline void setFunction(Func&& _function, BoundArgs&&... args) 
     { 
-        if constexpr(sizeof...(BoundArgs) == 0)
-            this->m_function = _function;
-        else
-        {
-            this->m_function = [=]{ return InvokeFunc(_function, args...); }; 
-        }
+        this->m_function = [_function = std::forward<Func>(_function), ...args = std::forward<BoundArgs>(args)](const void*) mutable { return InvokeFunc(_function, args...); }; 
+        this->m_id = newFuncID();
     }
 
     /// @returns true, if the function held is valid (not a nullptr)
@@ -46,7 +337,7 @@ public:
     { 
         // auto func_copy = this->m_function; // incase the func is deleted during call
         assert(("The function must be valid", this->isValid()));
-        return this->m_function();
+        return this->m_function(nullptr);
     }
 
     /// @brief invokes the currently set function
@@ -55,27 +346,51 @@ public:
         return this->invoke(); 
     }
 
+    /// @returns the id of the set function, copies of this func have the same id and every set function gets a new one
+    /// @note INVALID_FUNC_ID if no function was set
+    inline funcID getID() const
+    {
+        return this->m_id;
+    }
+
+    /// @returns the type name of the set function
+    /// @note only for displaying the function, functions of the same type have the same name so compare the ids instead
     inline const char* getTypeid() const
     { 
         return this->m_function.target_type().name();
     }
 
+    /// @brief invokes a copy of the currently set function on the given pool
+    /// @returns the result which can be waited on or chained with "then"
+    inline asyncResult<_ReturnType> invokeAsync(ThreadPool& pool = ThreadPool::getShared()) const requires Copyable
+    {
+        return this->runAsync(nullptr, pool, [](const auto& function){ return function(nullptr); });
+    }
+
+    /// @brief invokes a copy of the currently set function on the given pool
+    /// @param token if cancelled before the function starts then it is never called
+    /// @returns the result which can be waited on or chained with "then"
+    inline asyncResult<_ReturnType> invokeAsync(const cancelToken& token, ThreadPool& pool = ThreadPool::getShared()) const requires Copyable
+    {
+        return this->runAsync(token.m_cancelled, pool, [](const auto& function){ return function(nullptr); });
+    }
+
     /// @returns a copy of the bound std::function that is stored in this class
-    inline std::function<_ReturnType()> getBoundFunction() const
+    inline std::function<_ReturnType()> getBoundFunction() const requires Copyable
     { 
-        return m_function; 
+        return [function = m_function]{ return function(nullptr); }; 
     }
 
-    /// @warning only compares the typeid of the function
+    /// @note compares the ids of the functions
     inline friend bool operator< (const func& _func, const func& _func2)
     { 
-        return _func.getTypeid() < _func2.getTypeid(); 
+        return _func.getID() < _func2.getID(); 
     }
 
-    /// @warning only compares the typeid of the function
+    /// @note compares the ids of the functions (true if one is a copy of the other)
     inline friend bool operator== (const func& _func, const func& _func2)
     { 
-        return _func.getTypeid() == _func2.getTypeid(); 
+        return _func.getID() == _func2.getID(); 
     }
 
     /// @brief copies the given functions function 
@@ -88,483 +403,400 @@ public:
 
 protected:
     //* storage of the _function
-    std::function<_ReturnType()> m_function;
-
-    static std::deque<const void*> m_parameters;
-    static std::mutex _dynamic;
-
-    static void setMaxParameters(size_t extraParameters = 0);
-
-    /// @brief Turns the void* parameters back into its original type right before calling the callback function
-    template <typename Type>
-    static const std::decay_t<Type>& dereferenceParam(std::size_t paramIndex)
-    {
-        return *static_cast<const std::decay_t<Type>*>(m_parameters[paramIndex]);
-    }
+    /// @brief the function is given a pointer to the parameters of the current invoke (nullptr when there are none)
+    /// @note the parameters are a tuple of references made by the dynamic func being invoked, see "bindDynamic"
+    /// @note functions are stored without allocating unless they are bigger than FUNC_HELPER_INPLACE_CAPACITY
+    inplaceFunc<_ReturnType(const void*), FUNC_HELPER_INPLACE_CAPACITY, Copyable> m_function;
+    /// @brief given when the function is set, kept by copies
+    funcID m_id = INVALID_FUNC_ID;
 
     template<typename Func, typename... BoundArgs>
     static _ReturnType InvokeFunc(Func&& _function, BoundArgs&&... args)
     {
         return std::invoke(std::forward<Func>(_function), std::forward<BoundArgs>(args)...);
     }
-};
-
-template <typename T>
-std::mutex func<T>::_dynamic;
 
-template <typename T>
-std::deque<const void*> func<T>::m_parameters;
-
-template <typename T>
-void func<T>::setMaxParameters(size_t extraParameters)
-{
-    if (extraParameters > m_parameters.size())
-        m_parameters.resize(extraParameters);
-}
-
-/// Optional unbound parameters:
-/// - T (value according to template parameter)
-template <typename T>
-class funcDynamic : public func<void>
-{
-public:
-
-    inline funcDynamic()
-    {
-        func::setMaxParameters(1);
-    }
-
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr>
-    inline funcDynamic(const Func& _function, const BoundArgs&... args)
-    { 
-        func::setMaxParameters(1);
-        this->setFunction(_function, args...); 
-    }
-
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args...); }); 
-    }
-
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0)); }); 
-    }
-
-    /// @brief invokes the currently set function
-    inline void invoke(T param) const
+    /// @brief runs a copy of the function on the pool
+    /// @param call called on the pool with the copy of the function, should call it with the parameters of this invoke
+    template <typename Call>
+    asyncResult<_ReturnType> runAsync(std::shared_ptr<std::atomic<bool>> cancelled, ThreadPool& pool, Call&& call) const
     {
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        func::invoke();
-        _dynamic.unlock();
-    }
-
-    /// @brief invokes the currently set function
-    inline void operator() (T param)
-    { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        func::invoke(); 
-        _dynamic.unlock();
-    }
-
-    /// @returns a copy of the bound std::function that is stored in this class
-    inline std::function<void()> getBoundFunction() const
-    { 
-        return m_function; 
-    }
-
-    /// @warning only compares the typeid of the function
-    inline friend bool operator< (const funcDynamic& _funcDynamic, const funcDynamic& _funcDynamic2)
-    { 
-        return _funcDynamic.getTypeid() < _funcDynamic2.getTypeid(); 
-    }
-
-    /// @warning only compares the typeid of the function
-    inline friend bool operator== (const funcDynamic& _funcDynamic, const funcDynamic& _funcDynamic2)
-    { 
-        return _funcDynamic.getTypeid() == _funcDynamic2.getTypeid(); 
+        assert(("The function must be valid", this->isValid()));
+        auto state = std::make_shared<asyncState<_ReturnType>>(&pool, std::move(cancelled));
+        pool.submit([state, function = m_function, call = std::forward<Call>(call)]() mutable {
+            state->run([&]{ return call(function); });
+        });
+        return asyncResult<_ReturnType>(std::move(state));
     }
 };
 
-/// Optional unbound parameters:
-/// - T (value according to template parameter)
-/// - T2 (value according to template parameter)
-template <typename T, typename T2>
-class funcDynamic2 : public func<void>
+/// @brief Function with dynamic parameters that are given when invoking
+/// @note the function can take any number of bound arguments (set with the function) followed by any number of the dynamic parameters (from the front)
+/// @note parameters are given to the function by reference (const unless the parameter type is a non const reference) so invoking does not copy them
+/// @tparam Copyable if false the func is move only and can hold move only functions and bound arguments, use the funcDynamic and funcDynamicMoveOnly aliases
+template <bool Copyable, typename... Ts>
+class basicFuncDynamic : public func<void, Copyable>
 {
-public:
+protected:
+    /// @brief the parameters given to the function while invoking
+    using Params = std::tuple<dynamicParam<Ts>...>;
+
+    /// @brief true if the function can be called with the bound arguments followed by some of the dynamic parameters
+    template <typename Func, typename... BoundArgs>
+    static constexpr bool canBind = dynamicParamCount<void, Func, std::tuple<BoundArgs...>, Params>() != INVALID_PARAM_COUNT && isStorable<Copyable, Func, BoundArgs...>;
 
-    inline funcDynamic2()
+    /// @returns a function that keeps a copy of the parameters and calls the function it is given with them
+    static auto copyParams(dynamicParam<Ts>... params)
     {
-        func::setMaxParameters(2);
+        return [copies = std::tuple<std::remove_cvref_t<Ts>...>(params...)](const auto& function) mutable {
+            std::apply([&function](auto&... values){ 
+                const Params paramsTuple(values...);
+                function(&paramsTuple); 
+            }, copies);
+        };
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr>
-    inline funcDynamic2(const Func& _function, const BoundArgs&... args)
-    { 
-        func::setMaxParameters(2);
-        this->setFunction(_function, args...); 
-    }
+public:
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args...); }); 
-    }
+    inline basicFuncDynamic() = default;
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
+    /// @note the function and bound arguments are moved in when given as rvalues and copied otherwise
+    /// @note copyable funcs only take copyable functions and bound arguments, use a move only func for the others
+    template<typename Func, typename... BoundArgs, typename std::enable_if_t<!std::is_same_v<std::decay_t<Func>, basicFuncDynamic> && canBind<Func, BoundArgs...>>* = nullptr>
+    inline basicFuncDynamic(Func&& _function, BoundArgs&&... args)
     { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0)); }); 
+        this->setFunction(std::forward<Func>(_function), std::forward<BoundArgs>(args)...); 
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
+    /// @note the function and bound arguments are moved in when given as rvalues and copied otherwise
+    /// @note copyable funcs only take copyable functions and bound arguments, use a move only func for the others
+    template<typename Func, typename... BoundArgs, typename std::enable_if_t<canBind<Func, BoundArgs...>>* = nullptr>
+    inline void setFunction(Func&& _function, BoundArgs&&... args) 
     { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1)); }); 
+        this->m_function = bindDynamic<void, Params>(std::forward<Func>(_function), std::forward<BoundArgs>(args)...); 
+        this->m_id = newFuncID();
     }
 
     /// @brief invokes the currently set function
-    inline void invoke(T param, T2 param2)
+    inline void invoke(dynamicParam<Ts>... params) const
     { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        func::invoke();
-        _dynamic.unlock();
+        assert(("The function must be valid", this->isValid()));
+        const Params paramsTuple(params...);
+        this->m_function(&paramsTuple);
     }
 
     /// @brief invokes the currently set function
-    inline void operator() (T param, T2 param2)
+    inline void operator() (dynamicParam<Ts>... params) const
     { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        func::invoke();
-        _dynamic.unlock(); 
+        this->invoke(params...);
     }
 
-    /// @returns a copy of the bound std::function that is stored in this class
-    inline std::function<void()> getBoundFunction() const
-    { 
-        return m_function; 
-    }
-
-    /// @warning only compares the typeid of the function
-    inline friend bool operator< (const funcDynamic2& _funcDynamic2, const funcDynamic2& _funcDynamic22)
-    { 
-        return _funcDynamic2.getTypeid() < _funcDynamic22.getTypeid(); 
-    }
-
-    /// @warning only compares the typeid of the function
-    inline friend bool operator== (const funcDynamic2& _funcDynamic2, const funcDynamic2& _funcDynamic22)
-    { 
-        return _funcDynamic2.getTypeid() == _funcDynamic22.getTypeid(); 
-    }
-};
-
-/// Optional unbound parameters:
-/// - T (value according to template parameter)
-/// - T2 (value according to template parameter)
-/// - T3 (value according to template parameter)
-template <typename T, typename T2, typename T3>
-class funcDynamic3 : public func<void>
-{
-public:
-
-    inline funcDynamic3()
+    /// @brief invokes a copy of the currently set function on the given pool
+    /// @param params the parameters are copied until the function is called
+    /// @returns the result which can be waited on or chained with "then"
+    inline asyncResult<void> invokeAsync(dynamicParam<Ts>... params, ThreadPool& pool = ThreadPool::getShared()) const requires Copyable
     {
-        func::setMaxParameters(3);
+        return this->runAsync(nullptr, pool, copyParams(params...));
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value>* = nullptr>
-    inline funcDynamic3(const Func& _function, const BoundArgs&... args)
-    { 
-        func::setMaxParameters(3);
-        this->setFunction(_function, args...); 
-    }
-
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args...); }); 
-    }
-
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0)); }); 
+    /// @brief invokes a copy of the currently set function on the given pool
+    /// @param params the parameters are copied until the function is called
+    /// @param token if cancelled before the function starts then it is never called
+    /// @returns the result which can be waited on or chained with "then"
+    inline asyncResult<void> invokeAsync(dynamicParam<Ts>... params, const cancelToken& token, ThreadPool& pool = ThreadPool::getShared()) const requires Copyable
+    {
+        return this->runAsync(token.m_cancelled, pool, copyParams(params...));
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
+    /// @returns a copy of the bound function as a std::function that takes the dynamic parameters
+    inline std::function<void(Ts...)> getBoundFunction() const requires Copyable
     { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1)); }); 
+        return [function = this->m_function](dynamicParam<Ts>... params){ const Params paramsTuple(params...); function(&paramsTuple); }; 
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
+    /// @note compares the ids of the functions
+    inline friend bool operator< (const basicFuncDynamic& _funcDynamic, const basicFuncDynamic& _funcDynamic2)
     { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2)); }); 
+        return _funcDynamic.getID() < _funcDynamic2.getID(); 
     }
 
-    /// @brief invokes the currently set function
-    inline void invoke(T param, T2 param2, T3 param3)
+    /// @note compares the ids of the functions (true if one is a copy of the other)
+    inline friend bool operator== (const basicFuncDynamic& _funcDynamic, const basicFuncDynamic& _funcDynamic2)
     { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        func::invoke();
-        _dynamic.unlock();
+        return _funcDynamic.getID() == _funcDynamic2.getID(); 
     }
+};
 
-    /// @brief invokes the currently set function
-    inline void operator() (T param, T2 param2, T3 param3)
-    { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        func::invoke();
-        _dynamic.unlock(); 
-    }
+/// @brief func that is move only so it can hold move only functions and bound arguments
+template<typename _ReturnType = void>
+using funcMoveOnly = func<_ReturnType, false>;
 
-    /// @returns a copy of the bound std::function that is stored in this class
-    inline std::function<void()> getBoundFunction() const
-    { 
-        return m_function; 
-    }
+template <typename... Ts>
+using funcDynamic = basicFuncDynamic<true, Ts...>;
+/// @brief funcDynamic that is move only so it can hold move only functions and bound arguments
+template <typename... Ts>
+using funcDynamicMoveOnly = basicFuncDynamic<false, Ts...>;
 
-    /// @warning only compares the typeid of the function
-    inline friend bool operator< (const funcDynamic3& _funcDynamic3, const funcDynamic3& _funcDynamic32)
-    { 
-        return _funcDynamic3.getTypeid() < _funcDynamic32.getTypeid(); 
-    }
+template <typename T, typename T2>
+using funcDynamic2 = funcDynamic<T, T2>;
+template <typename T, typename T2, typename T3>
+using funcDynamic3 = funcDynamic<T, T2, T3>;
+template <typename T, typename T2, typename T3, typename T4>
+using funcDynamic4 = funcDynamic<T, T2, T3, T4>;
+template <typename T, typename T2, typename T3, typename T4, typename T5>
+using funcDynamic5 = funcDynamic<T, T2, T3, T4, T5>;
 
-    /// @warning only compares the typeid of the function
-    inline friend bool operator== (const funcDynamic3& _funcDynamic3, const funcDynamic3& _funcDynamic32)
-    { 
-        return _funcDynamic3.getTypeid() == _funcDynamic32.getTypeid(); 
+/// @brief hashes a tuple by combining the std::hash of every element
+struct tupleHash
+{
+    template <typename... Ts>
+    std::size_t operator()(const std::tuple<Ts...>& tuple) const
+    {
+        return std::apply([](const Ts&... values){
+            std::size_t seed = 0;
+            ((seed ^= std::hash<Ts>()(values) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)), ...);
+            return seed;
+        }, tuple);
     }
 };
 
-/// Optional unbound parameters:
-/// - T (value according to template parameter)
-/// - T2 (value according to template parameter)
-/// - T3 (value according to template parameter)
-/// - T4 (value according to template parameter)
-template <typename T, typename T2, typename T3, typename T4>
-class funcDynamic4 : public func<void>
+/// @brief Function with dynamic parameters that caches its results based on the parameters
+/// @note only for pure functions, the function is only called when there is no cached result for the given parameters
+/// @note the least recently used result is removed once there are more than "capacity" results, results can also expire after a set time
+/// @note can be invoked from multiple threads at once, the function is called outside of the lock so multiple threads may compute the same result at once
+/// @note the parameters are copied as the key so they must be copyable, equality comparable, and have a std::hash
+/// @tparam _ReturnType the result that is cached, returned by copy since it could be removed from the cache at any time
+template <typename _ReturnType, typename... Ts>
+class funcMemoized
 {
 public:
+    static_assert(!std::is_void_v<_ReturnType>, "A memoized function must return the value that is cached");
 
-    inline funcDynamic4()
-    {
-        func::setMaxParameters(4);
-    }
+    using Clock = std::chrono::steady_clock;
+    /// @brief the parameters given to the function while invoking
+    using Params = std::tuple<dynamicParam<Ts>...>;
+    /// @brief the copies of the parameters that results are cached by
+    using Key = std::tuple<std::remove_cvref_t<Ts>...>;
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4)>>::value>* = nullptr>
-    inline funcDynamic4(const Func& _function, const BoundArgs&... args)
-    { 
-        func::setMaxParameters(4);
-        this->setFunction(_function, args...); 
-    }
+    /// @brief stats of the cache since it was created or since "resetStats"
+    struct Stats
+    {
+        /// @brief number of invokes that used a cached result
+        size_t hits = 0;
+        /// @brief number of invokes that called the function
+        size_t misses = 0;
+        /// @brief number of results removed because the cache was full
+        size_t evictions = 0;
+        /// @brief number of results removed because they where older than the time to live
+        size_t expirations = 0;
+        /// @brief number of results currently cached
+        size_t size = 0;
+    };
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args...); }); 
-    }
+    /// @note the default capacity of a memoized func
+    static constexpr size_t DEFAULT_CAPACITY = 128;
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0)); }); 
-    }
+    inline funcMemoized() = default;
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1)); }); 
+    /// @note the function and bound arguments are moved in when given as rvalues and copied otherwise
+    template<typename Func, typename... BoundArgs, typename std::enable_if_t<!std::is_same_v<std::decay_t<Func>, funcMemoized> &&
+                                                                             dynamicParamCount<_ReturnType, Func, std::tuple<BoundArgs...>, Params>() != INVALID_PARAM_COUNT>* = nullptr>
+    inline funcMemoized(Func&& _function, BoundArgs&&... args)
+    {
+        this->setFunction(std::forward<Func>(_function), std::forward<BoundArgs>(args)...);
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2)); }); 
-    }
+    /// @note the cache belongs to this object so it can not be copied or moved
+    funcMemoized(const funcMemoized&) = delete;
+    funcMemoized& operator=(const funcMemoized&) = delete;
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3)); }); 
+    /// @brief sets the function and clears the cache
+    /// @note the function and bound arguments are moved in when given as rvalues and copied otherwise
+    /// @note invokes that are already calling the old function finish with it but there results are not cached
+    template<typename Func, typename... BoundArgs, typename std::enable_if_t<dynamicParamCount<_ReturnType, Func, std::tuple<BoundArgs...>, Params>() != INVALID_PARAM_COUNT>* = nullptr>
+    inline void setFunction(Func&& _function, BoundArgs&&... args)
+    {
+        auto function = std::make_shared<const Function>(bindDynamic<_ReturnType, Params>(std::forward<Func>(_function), std::forward<BoundArgs>(args)...));
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_function = std::move(function);
+        ++m_generation;
+        m_order.clear();
+        m_cache.clear();
     }
 
-    /// @brief invokes the currently set function
-    inline void invoke(T param, T2 param2, T3 param3, T4 param4)
+    /// @returns true, if the function held is valid (not a nullptr)
+    inline bool isValid() const 
     { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        m_parameters[3] = static_cast<const void*>(&param4);
-        func::invoke();
-        _dynamic.unlock();
+        std::lock_guard<std::mutex> guard(m_lock);
+        return m_function != nullptr && (bool)*m_function; 
     }
 
-    /// @brief invokes the currently set function
-    inline void operator() (T param, T2 param2, T3 param3, T4 param4)
-    { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        m_parameters[3] = static_cast<const void*>(&param4);
-        func::invoke();
-        _dynamic.unlock(); 
+    /// @brief returns the cached result for the given parameters or calls the function and caches its result
+    /// @note if the function throws nothing is cached
+    _ReturnType invoke(dynamicParam<Ts>... params) const
+    {
+        Key key(params...);
+        const Clock::duration timeToLive = m_timeToLive.load(std::memory_order_relaxed);
+        // only reading the clock when results can expire since it is not free
+        const Clock::time_point now = (timeToLive != Clock::duration::zero()) ? Clock::now() : Clock::time_point();
+        // results cached without a time to live never expire, even if one is set later
+        const Clock::time_point expires = (timeToLive != Clock::duration::zero()) ? now + timeToLive : Clock::time_point::max();
+        // the function is called without the lock so it is kept alive in case it is changed while being called
+        std::shared_ptr<const Function> function;
+        size_t generation;
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            auto iter = m_cache.find(key);
+            if (iter != m_cache.end())
+            {
+                const Clock::time_point cachedExpires = iter->second->expires;
+                if (cachedExpires == Clock::time_point::max() || (timeToLive != Clock::duration::zero() ? now : Clock::now()) < cachedExpires)
+                {
+                    m_order.splice(m_order.begin(), m_order, iter->second);
+                    m_hits.fetch_add(1, std::memory_order_relaxed);
+                    return iter->second->value;
+                }
+                m_order.erase(iter->second);
+                m_cache.erase(iter);
+                m_expirations.fetch_add(1, std::memory_order_relaxed);
+            }
+            function = m_function;
+            generation = m_generation;
+        }
+        assert(("The function must be valid", function != nullptr && (bool)*function));
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+
+        const Params paramsTuple(params...);
+        _ReturnType result = (*function)(&paramsTuple);
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        // the result of an old function is not cached
+        if (m_capacity == 0 || generation != m_generation)
+            return result;
+        auto iter = m_cache.find(key);
+        // another thread may have cached the same parameters while the function was running
+        if (iter != m_cache.end())
+        {
+            iter->second->value = result;
+            iter->second->expires = expires;
+            m_order.splice(m_order.begin(), m_order, iter->second);
+            return result;
+        }
+        m_order.push_front({key, result, expires});
+        m_cache.emplace(std::move(key), m_order.begin());
+        while (m_cache.size() > m_capacity)
+            this->evictOldest();
+        return result;
     }
 
-    /// @returns a copy of the bound std::function that is stored in this class
-    inline std::function<void()> getBoundFunction() const
-    { 
-        return m_function; 
+    /// @brief returns the cached result for the given parameters or calls the function and caches its result
+    inline _ReturnType operator() (dynamicParam<Ts>... params) const
+    {
+        return this->invoke(params...);
     }
 
-    /// @warning only compares the typeid of the function
-    inline friend bool operator< (const funcDynamic4& _funcDynamic4, const funcDynamic4& _funcDynamic42)
-    { 
-        return _funcDynamic4.getTypeid() < _funcDynamic42.getTypeid(); 
+    /// @returns true if there is a result cached for the given parameters (even if it has expired)
+    inline bool isCached(dynamicParam<Ts>... params) const
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        return m_cache.find(Key(params...)) != m_cache.end();
     }
 
-    /// @warning only compares the typeid of the function
-    inline friend bool operator== (const funcDynamic4& _funcDynamic4, const funcDynamic4& _funcDynamic42)
-    { 
-        return _funcDynamic4.getTypeid() == _funcDynamic42.getTypeid(); 
+    /// @brief removes the cached result for the given parameters
+    /// @returns true if there was a cached result
+    inline bool erase(dynamicParam<Ts>... params)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto iter = m_cache.find(Key(params...));
+        if (iter == m_cache.end())
+            return false;
+        m_order.erase(iter->second);
+        m_cache.erase(iter);
+        return true;
     }
-};
 
-/// Optional unbound parameters:
-/// - T (value according to template parameter)
-/// - T2 (value according to template parameter)
-/// - T3 (value according to template parameter)
-/// - T4 (value according to template parameter)
-/// - T5 (value according to template parameter)
-template <typename T, typename T2, typename T3, typename T4, typename T5>
-class funcDynamic5 : public func<void>
-{
-public:
-
-    inline funcDynamic5()
+    /// @brief removes all cached results
+    inline void clear()
     {
-        func::setMaxParameters(5);
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_order.clear();
+        m_cache.clear();
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value ||
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4)>>::value || 
-        std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4, T5)>>::value>* = nullptr>
-    inline funcDynamic5(const Func& _function, const BoundArgs&... args)
-    { 
-        func::setMaxParameters(5);
-        this->setFunction(_function, args...); 
+    /// @brief sets the max number of results that are cached, the least recently used are removed first
+    /// @note 0 disables caching
+    inline void setCapacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_capacity = capacity;
+        while (m_cache.size() > m_capacity)
+            this->evictOldest();
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&...)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args...); }); 
-    }
+    inline size_t getCapacity() const { return m_capacity; }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0)); }); 
-    }
+    /// @brief sets how long results stay cached after they are computed
+    /// @note zero (the default) means results never expire
+    /// @note only effects results cached after this is set, results cached before keep the time to live they where cached with
+    inline void setTimeToLive(Clock::duration timeToLive) { m_timeToLive = timeToLive; }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1)); }); 
-    }
+    inline Clock::duration getTimeToLive() const { return m_timeToLive.load(); }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2)); }); 
+    /// @note can be called from any thread
+    inline Stats getStats() const
+    {
+        Stats stats;
+        stats.hits = m_hits.load(std::memory_order_relaxed);
+        stats.misses = m_misses.load(std::memory_order_relaxed);
+        stats.evictions = m_evictions.load(std::memory_order_relaxed);
+        stats.expirations = m_expirations.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> guard(m_lock);
+        stats.size = m_cache.size();
+        return stats;
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3)); }); 
+    inline void resetStats()
+    {
+        m_hits = 0;
+        m_misses = 0;
+        m_evictions = 0;
+        m_expirations = 0;
     }
 
-    template<typename Func, typename... BoundArgs, typename std::enable_if_t<std::is_convertible<Func, std::function<void(const BoundArgs&..., T, T2, T3, T4, T5)>>::value>* = nullptr>
-    inline void setFunction(const Func& _function, const BoundArgs&... args) 
-    { 
-        func::setFunction([=]{ return InvokeFunc(_function, args..., dereferenceParam<T>(0), dereferenceParam<T2>(1), dereferenceParam<T3>(2), dereferenceParam<T4>(3), dereferenceParam<T5>(4)); }); 
-    }
+private:
+    struct Entry
+    {
+        Key key;
+        _ReturnType value;
+        Clock::time_point expires;
+    };
 
-    /// @brief invokes the currently set function
-    inline void invoke(T param, T2 param2, T3 param3, T4 param4, T5 param5)
-    { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        m_parameters[3] = static_cast<const void*>(&param4);
-        m_parameters[4] = static_cast<const void*>(&param5);
-        func::invoke();
-        _dynamic.unlock();
+    /// @note the lock must be held
+    inline void evictOldest() const
+    {
+        m_cache.erase(m_order.back().key);
+        m_order.pop_back();
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
     }
 
-    /// @brief invokes the currently set function
-    inline void operator() (T param, T2 param2, T3 param3, T4 param4, T5 param5)
-    { 
-        _dynamic.lock();
-        m_parameters[0] = static_cast<const void*>(&param);
-        m_parameters[1] = static_cast<const void*>(&param2);
-        m_parameters[2] = static_cast<const void*>(&param3);
-        m_parameters[3] = static_cast<const void*>(&param4);
-        m_parameters[4] = static_cast<const void*>(&param5);
-        func::invoke();
-        _dynamic.unlock(); 
-    }
+    using Function = inplaceFunc<_ReturnType(const void*)>;
 
-    /// @returns a copy of the bound std::function that is stored in this class
-    inline std::function<void()> getBoundFunction() const
-    { 
-        return m_function; 
-    }
+    /// @brief only changed with the lock held, invokes keep a copy of the pointer while calling it
+    std::shared_ptr<const Function> m_function;
+    /// @brief changed each time the function is set so results of the old function are not cached
+    size_t m_generation = 0;
 
-    /// @warning only compares the typeid of the function
-    inline friend bool operator< (const funcDynamic5& _funcDynamic5, const funcDynamic5& _funcDynamic52)
-    { 
-        return _funcDynamic5.getTypeid() < _funcDynamic52.getTypeid(); 
-    }
+    mutable std::mutex m_lock;
+    /// @brief most recently used first
+    mutable std::list<Entry> m_order;
+    mutable std::unordered_map<Key, typename std::list<Entry>::iterator, tupleHash> m_cache;
+    std::atomic<size_t> m_capacity = DEFAULT_CAPACITY;
+    std::atomic<Clock::duration> m_timeToLive = Clock::duration::zero();
 
-    /// @warning only compares the typeid of the function
-    inline friend bool operator== (const funcDynamic5& _funcDynamic5, const funcDynamic5& _funcDynamic52)
-    { 
-        return _funcDynamic5.getTypeid() == _funcDynamic52.getTypeid(); 
-    }
+    mutable std::atomic<size_t> m_hits = 0;
+    mutable std::atomic<size_t> m_misses = 0;
+    mutable std::atomic<size_t> m_evictions = 0;
+    mutable std::atomic<size_t> m_expirations = 0;
 };
 
 }
@@ -574,8 +806,7 @@ namespace std {
     struct hash<funcHelper::func<_ReturnType>> {
         std::size_t operator()(const funcHelper::func<_ReturnType>& func) const
         {
-            // You can use the std::hash function to hash the type name of the function
-            return std::hash<const char*>()(func.getTypeid());
+            return std::hash<funcHelper::funcID>()(func.getID());
         }
     };
 }
@@ -5,8 +5,20 @@
 
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <map>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <any>
+#include <unordered_map>
+#include <charconv>
+#include <type_traits>
+#include <chrono>
+
+#include "Utils/StringHelper.hpp"
 
 //* -------------------------------------------
 
@@ -20,52 +32,210 @@
 
 class iniParser
 {
+private:
+    /// @brief open addressing (linear probing) hash table of positions in some list of keys
+    /// @note only the hash and position are stored, keys are read back through the given "keyAt" function when comparing
+    class HashIndex
+    {
+    public:
+        static constexpr uint32_t npos = UINT32_MAX;
+
+        inline static size_t hash(std::string_view key) { return std::hash<std::string_view>{}(key); }
+        /// @param keyAt function that returns the key (as a string_view) at the given position
+        /// @returns the position of the key or npos if it is not in the index
+        template <typename KeyAt>
+        uint32_t find(std::string_view key, size_t hash, const KeyAt& keyAt) const;
+        /// @note does not check if the key is already in the index
+        void insert(size_t hash, uint32_t position);
+        /// @brief removes the position that was inserted with the given hash
+        void erase(size_t hash, uint32_t position);
+        void clear();
+        void reserve(size_t count);
+        inline size_t size() const { return m_size; }
+
+    private:
+        struct Slot
+        {
+            uint32_t hash = 0;
+            uint32_t position = npos;
+        };
+
+        std::vector<Slot> m_slots;
+        size_t m_size = 0;
+    };
+
+    /// @brief the entries of a map in the order they where added with a hash index over them so looking up a string_view does not allocate
+    /// @note the map owns the entries, this only points to them (map nodes never move)
+    /// @note small maps are searched in order without an index
+    template <typename Map>
+    class OrderedIndex
+    {
+    public:
+        using Entry = typename Map::value_type;
+
+        /// @returns the entry with the given key or nullptr
+        Entry* find(std::string_view key) const;
+        /// @returns the position of the entry with the given key or HashIndex::npos
+        uint32_t position(std::string_view key) const;
+        inline Entry* at(uint32_t position) const { return m_order[position]; }
+        /// @brief adds an entry that was just added to the map
+        void add(Entry& entry);
+        /// @brief same as "add" but the index is not updated, "buildIndex" has to be called before the next lookup
+        /// @note faster when adding many entries at once
+        inline void append(Entry& entry) { m_order.push_back(&entry); }
+        void buildIndex();
+        /// @brief removes the entry at the given position, the map entry should be erased after this
+        void remove(uint32_t position);
+        /// @brief updates the index after the key at the given position was changed
+        /// @param oldHash the hash of the key before it was changed
+        void rename(uint32_t position, size_t oldHash);
+        void clear();
+        /// @brief calls the function with each entry in the order they where added
+        template <typename Function>
+        void forEach(const Function& function) const;
+        /// @brief uses the order of "other" for the entries in "map" (a copy of the map "other" indexes)
+        void copyOrder(const OrderedIndex& other, Map& map);
+        /// @brief marks the order as out of date since the map could be changed directly
+        inline void invalidate() { m_valid = false; }
+        /// @brief brings the order and index up to date with the map if it was invalidated
+        /// @note entries that are still in the map keep their order and any new ones are added after them
+        inline void sync(Map& map) { if (!m_valid) this->rebuild(map); }
+
+    private:
+        void rebuild(Map& map);
+
+        /// @brief the entries in the order they where added, removed entries are nullptr until the next compact
+        std::vector<Entry*> m_order;
+        size_t m_removed = 0;
+        /// @brief positions in m_order, only used once there are enough entries
+        HashIndex m_index;
+        bool m_indexed = false;
+        bool m_valid = true;
+    };
+
 public:
+    /// @brief the read only contents of a file, memory mapped where supported
+    class MappedFile;
+
+    /// @note lookups take a string_view so strings, literals, and views are all found without allocating
+    /// @note keys are saved in the order they where added
     class SectionData
     {
     public:
         inline SectionData() {}
+        SectionData(const SectionData& other);
+        SectionData& operator=(const SectionData& other);
+        SectionData(SectionData&&) = default;
+        SectionData& operator=(SectionData&&) = default;
+
         /// @exception if the key was not found then returns nullptr
         /// @returns pointer to the value from the given key
-        const std::string* getValue(const std::string& key) const;
+        const std::string* getValue(std::string_view key) const;
         /// @exception if the key was not found then returns nullptr
         /// @returns pointer to the value from the given key
-        std::string* getValue(const std::string& key);
+        std::string* getValue(std::string_view key);
         /// @brief tries to find the given key and return the value
         /// @note if the key is not found it will be created with an empty string
         /// @note if you need a getter without making the key value pair if they dont exist use "getValue"
-        std::string& operator[](const std::string& key);
-        inline std::map<std::string, std::string>& getData() { return m_data; }
-        inline const std::map<std::string, std::string>& getData() const { return m_data; }
+        std::string& operator[](std::string_view key);
+        /// @brief converts the value to the given type the first time it is read and returns the cached value after that
+        /// @note supports numbers, bools, vectors of numbers (e.g. "[1, 2, 3]"), and any type that can be made from a std::string (e.g. Vector2)
+        /// @note the cached value is converted again if the value string changed since it was cached (even through a reference or the map from getData)
+        /// @note a mapped section is not copied (see "iniParser::parseMapped")
+        /// @warning the returned pointer is only valid until the value is changed, removed, or read as a different type
+        /// @returns nullptr if the key was not found or the value could not be converted
+        template <typename T>
+        const T* getValue(std::string_view key) const;
+        /// @returns the value without copying it or nullopt if the key was not found
+        /// @note does not copy a mapped section (see "iniParser::parseMapped")
+        std::optional<std::string_view> getView(std::string_view key) const;
+        /// @returns true if the keys and values are still views into the mapped file (see "iniParser::parseMapped")
+        inline bool isMapped() const { return m_source != nullptr; }
+        /// @note changing the map directly means the key order has to be rebuilt before the next lookup, prefer the functions of this class when possible
+        /// @warning do not keep the reference around to change the map after using the other functions of this class
+        inline std::map<std::string, std::string>& getData() { this->copyMapped(); m_keys.invalidate(); m_cache.clear(); m_savedValues.clear(); m_keysChanged = true; return m_data; }
+        inline const std::map<std::string, std::string>& getData() const { this->copyMapped(); return m_data; }
 
         /// @brief inserts the <key, value> pair to the data in this section
         /// @note if the key already exists then it wont be replaced (boolean will be false)
         /// @returns a pair<value str, replaced> where first element is the keys value string and the second element is true if the given value was used
-        inline std::pair<std::string&, bool> insert(const std::string& key, const std::string& value) 
-        { 
-            auto temp = m_data.emplace(key, value);
-            return {temp.first->second, temp.second};
-        }
+        std::pair<std::string&, bool> insert(std::string_view key, const std::string& value);
         /// @note if the key does not exists it will be created
         /// @returns a reference to the value string
-        inline std::string& setValue(const std::string& key, const std::string& value)
-        {
-            std::string& rtn = m_data[key];
-            rtn = value;
-            return rtn;
-        }
+        std::string& setValue(std::string_view key, const std::string& value);
         /// @note if the newKey already exists then it will return a valid pointer and false
+        /// @note the key keeps its place in the saved order
         /// @returns a pair<value str, found> where first element is the keys value string (if found else nullptr) and the second element is true if the given key was found and renamed
-        std::pair<std::string*, bool> changeKey(const std::string& originalKey, const std::string& newKey);
+        std::pair<std::string*, bool> changeKey(std::string_view originalKey, std::string_view newKey);
         /// @brief removes the key if in this section
         /// @returns false if the key was not found
-        bool remove(const std::string& key);
+        bool remove(std::string_view key);
         /// @brief removes all data from this section
-        inline void removeAll() { m_data.clear(); }
+        inline void removeAll() { m_data.clear(); m_keys.clear(); m_views.clear(); m_viewIndex.clear(); m_source.reset(); m_cache.clear(); m_savedValues.clear(); m_keysChanged = true; }
 
     private:
+        friend class iniParser;
+
+        /// @brief copies the mapped keys and values into the owned data so they can be returned as strings or changed
+        /// @note const since reading through the std::string getters needs the owned data
+        inline void copyMapped() const { if (m_source != nullptr) this->copyViews(); }
+        void copyViews() const;
+        /// @returns the owned entry with the given key or nullptr
+        std::pair<const std::string, std::string>* find(std::string_view key) const;
+        /// @brief adds a new key to the owned data
+        std::pair<const std::string, std::string>& add(std::string_view key, std::string value) const;
+        /// @returns the position of the key in the mapped views or HashIndex::npos
+        uint32_t findView(std::string_view key, size_t hash) const;
+        /// @brief adds a key to the mapped views if it is not already in them
+        /// @returns false if the key was already added
+        bool addView(std::string_view key, std::string_view value);
+        /// @brief drops the typed value cached for the given value string
+        inline void uncache(const std::string& value) const { if (!m_cache.empty()) m_cache.erase(&value); }
+        /// @brief starts tracking the value since it could be changed through a returned reference
+        /// @note must be called before the value is changed so what was saved is kept
+        inline void changed(const std::string& value) { this->uncache(value); m_savedValues.try_emplace(&value, value); }
+        /// @returns true if the value is different from when it was last parsed or saved
+        bool isChanged(const std::string& value) const;
+        /// @returns true if this section changed since it was last parsed or saved
+        bool isChanged() const;
+        /// @brief the current values become the saved ones, values that where handed out are still tracked since the references could still be used
+        void markSaved();
+
+        template <typename T>
+        struct IsVector : std::false_type {};
+        template <typename T>
+        struct IsVector<std::vector<T>> : std::true_type {};
+        /// @returns the value converted to the given type or nullopt if it could not be converted
+        template <typename T>
+        static std::optional<T> convert(std::string_view value);
+
         /// @brief map<keyName, valueString>
-        std::map<std::string, std::string> m_data = {};
+        /// @note mutable so mapped sections can be copied in const getters
+        mutable std::map<std::string, std::string> m_data = {};
+        /// @brief the keys in m_data in the order they where added
+        mutable OrderedIndex<std::map<std::string, std::string>> m_keys;
+        /// @brief the keys and values in the mapped file in file order, only used while mapped
+        mutable std::vector<std::pair<std::string_view, std::string_view>> m_views = {};
+        /// @brief positions in m_views, only used once there are enough views
+        mutable HashIndex m_viewIndex;
+        /// @brief keeps the mapped file alive while there are views into it
+        mutable std::shared_ptr<const MappedFile> m_source = nullptr;
+        /// @brief a typed value from "getValue<T>" and the value string it was converted from
+        struct CachedValue
+        {
+            /// @brief the value string when it was converted, values can be changed through returned references so this is checked on every read
+            /// @note empty for mapped views since they never change
+            std::string source;
+            /// @brief optional<T>
+            std::any value;
+        };
+        /// @brief typed values from "getValue<T>", keyed by the value string (or mapped view) they where converted from
+        mutable std::unordered_map<const void*, CachedValue> m_cache = {};
+        /// @brief the values that a non const reference was returned for and what they where when the section was last parsed or saved
+        /// @note kept after saving so changes through a reference that is held across a save are still saved
+        std::unordered_map<const std::string*, std::string> m_savedValues = {};
+        /// @brief true if keys could have been added, removed, or renamed since the section was last parsed or saved
+        bool m_keysChanged = true;
     };
 
     struct FormatErrors
@@ -108,6 +278,11 @@ public:
     /// @warning all data will be removed before parsing (no autosave)
     /// @returns if there was any data parsed (could still have format errors)
     bool parseData(bool ignoreDuplicateSections = true);
+    /// @brief same as "parseData" but the keys and values are left as views into the memory mapped file instead of being copied
+    /// @note a section is only copied into strings once it is changed or read through something that returns a std::string, use "SectionData::getView" to read without copying
+    /// @note the file stays mapped until every mapped section is copied or removed
+    /// @returns if there was any data parsed (could still have format errors)
+    bool parseMapped(bool ignoreDuplicateSections = true);
 
     /// @brief sets the data that the iniParse is holding
     void setData(const std::map<std::string, SectionData>& Data);
@@ -128,36 +303,29 @@ public:
     void createCopyError(const std::string path = "");
 
     /// @brief the data is stored as follows std::map<"SectionName", std::map<"KeyName", "KeyValue">>
-    inline std::map<std::string, SectionData>& getData() { return m_data; }
+    /// @note changing the map directly means the section order has to be rebuilt before the next lookup, prefer the functions of this class when possible
+    /// @warning do not keep the reference around to add or remove sections after using the other functions of this class
+    inline std::map<std::string, SectionData>& getData() { m_sections.invalidate(); m_layoutKnown = false; return m_data; }
     inline const std::map<std::string, SectionData>& getData() const { return m_data; }
 
     /// @exception if the section does not exist returns nullptr
     /// @returns the pointer to the SectionData with the given name
-    SectionData* getSection(const std::string& section);
+    SectionData* getSection(std::string_view section);
     /// @exception if the section does not exist returns nullptr
     /// @returns the pointer to the SectionData with the given name
-    const SectionData* getSection(const std::string& section) const;
+    const SectionData* getSection(std::string_view section) const;
     /// @note if the section does not exist then it will be made
     /// @note if you need a getter without making the SectionData if it does not exist use "getSection"
-    SectionData& operator[](const std::string& section);
+    SectionData& operator[](std::string_view section);
 
     /// @brief adds the given section if it does not already exist
     /// @note if the section already exists it will not be replaced
     /// @returns a pair where the first element is a reference to the section and the second element is whether a new section was made or it already existed
-    inline std::pair<iniParser::SectionData&, bool> insertSection(const std::string& section, const SectionData& sectionData = SectionData())
-    {
-        auto temp = m_data.emplace(section, sectionData);
-        return {temp.first->second, temp.second};
-    }
+    std::pair<iniParser::SectionData&, bool> insertSection(std::string_view section, const SectionData& sectionData = SectionData());
     /// @note if the section does not exist it will be created
-    inline iniParser::SectionData& setSection(const std::string& section, const SectionData& sectionData)
-    {
-        iniParser::SectionData& rtn = m_data[section];
-        rtn = sectionData;
-        return rtn;
-    }
+    iniParser::SectionData& setSection(std::string_view section, const SectionData& sectionData);
     /// @returns true if the section was found and removed 
-    bool removeSection(const std::string& section);
+    bool removeSection(std::string_view section);
 
     /// @brief Autosave[Default] = true;
     /// @param Autosave false then the data will not be saved when closing the file or when destroying this obj
@@ -166,15 +334,64 @@ public:
     /// @brief Default is true
     bool isAutosave() const;
 
+    /// @brief saves at most once every "delay" while "update" is being called so many changes are merged into one write
+    /// @note a delay of 0 (default) only autosaves when closing the file or destroying this
+    void setAutosaveDelay(std::chrono::milliseconds delay);
+    std::chrono::milliseconds getAutosaveDelay() const;
+    /// @brief saves if autosave is on, the autosave delay has passed since the last save or check, and there are unsaved changes
+    /// @note call this regularly (e.g. once a frame) when using an autosave delay
+    void update();
+
+    /// @brief writes the sections and keys in the order they where added (file order for parsed data)
+    /// @note if only some sections changed and they still take the same number of bytes then only the changed bytes are written in place
+    /// @note otherwise the whole file is written to a temp file which is then renamed over the old one so a crash never leaves a partly written file
+    /// @note does nothing if there are no changes since the file was last parsed or saved
+    /// @note values changed through a reference that was returned before the last save are still saved (they are compared to what was saved)
     /// @returns false if the data was not able to be saved or there was no data to save
     bool save();
+    /// @returns true if there could be changes that are not saved to the open file
+    bool isDirty() const;
 
     /// @brief attempts to create the given file and its directories if it does not already exit
     static void createFile(const std::filesystem::path& filePath);
 
 private:
+    /// @param mapped if true the sections keep views into the file instead of copies
+    bool parse(bool ignoreDuplicateSections, bool mapped);
+    /// @returns the section with the given name or nullptr
+    std::pair<const std::string, SectionData>* find(std::string_view section) const;
+    /// @brief adds a new section to the data
+    std::pair<const std::string, SectionData>& add(std::string_view section, SectionData&& sectionData);
+    /// @brief writes only the changed sections into the file where they already are
+    /// @returns false if the file or layout changed so the whole file has to be written
+    bool saveChanges();
+    /// @brief writes every section to a temp file and renames it over the open file
+    bool saveAll();
+    /// @brief appends the section as it is saved to the file
+    static void appendSection(std::string& text, const std::pair<const std::string, SectionData>& section);
+    /// @brief records the size and write time of the file so changes by anything else can be noticed
+    void recordFileState();
+
     FormatErrors m_formatErrors;
     bool m_autosave = true;
+    std::chrono::milliseconds m_autosaveDelay{0};
+    std::chrono::steady_clock::time_point m_nextAutosave = {};
+
+    /// @brief where a section is in the file
+    struct SectionSpan
+    {
+        std::pair<const std::string, SectionData>* section;
+        uint64_t offset;
+        uint64_t size;
+        /// @brief true if the section in the file is exactly how it would be saved (no comments, extra spaces, ...) so single values can be written
+        bool canonical;
+    };
+    /// @brief the sections in file order with where they are in the file, only valid while m_layoutKnown is true
+    std::vector<SectionSpan> m_layout;
+    /// @brief true if m_layout matches the open file and no sections where added or removed since
+    bool m_layoutKnown = false;
+    uintmax_t m_fileSize = 0;
+    std::filesystem::file_time_type m_fileTime = {};
 
     std::filesystem::path m_filePath = "";
     
@@ -182,6 +399,87 @@ private:
 
     /// map<sectionName, SectionData>
     std::map<std::string, SectionData> m_data;
+    /// @brief the sections in m_data in the order they where added
+    mutable OrderedIndex<std::map<std::string, SectionData>> m_sections;
 };
 
+template <typename T>
+const T* iniParser::SectionData::getValue(std::string_view key) const
+{
+    static_assert(!std::is_same_v<T, std::string>, "use the non template getValue for strings");
+
+    // the cache is keyed by the value so renaming the key does not need to drop it
+    const void* source = nullptr;
+    std::string_view value;
+    const bool mapped = m_source != nullptr;
+    if (mapped)
+    {
+        const uint32_t position = this->findView(key, HashIndex::hash(key));
+        if (position == HashIndex::npos)
+            return nullptr;
+        source = &m_views[position];
+        value = m_views[position].second;
+    }
+    else
+    {
+        auto entry = this->find(key);
+        if (entry == nullptr)
+            return nullptr;
+        source = &entry->second;
+        value = entry->second;
+    }
+
+    CachedValue& cached = m_cache[source];
+    auto typed = std::any_cast<std::optional<T>>(&cached.value);
+    // first read, last read as a different type, or the value was changed through a reference since it was converted
+    if (typed == nullptr || (!mapped && cached.source != value))
+    {
+        cached.value = convert<T>(value);
+        if (!mapped)
+            cached.source = value;
+        typed = std::any_cast<std::optional<T>>(&cached.value);
+    }
+    return typed->has_value() ? &typed->value() : nullptr;
+}
+
+template <typename T>
+std::optional<T> iniParser::SectionData::convert(std::string_view value)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        bool result;
+        if (StringHelper::attemptToBool(std::string(value), result))
+            return result;
+        return std::nullopt;
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+        const size_t first = value.find_first_not_of(" \t\n\r\f\v");
+        if (first == std::string_view::npos)
+            return std::nullopt;
+        value = value.substr(first, value.find_last_not_of(" \t\n\r\f\v") - first + 1);
+
+        T result;
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+        // the whole value has to be the number (i.e. "12abc" is not 12)
+        if (error != std::errc{} || end != value.data() + value.size())
+            return std::nullopt;
+        return result;
+    }
+    else if constexpr (IsVector<T>::value)
+    {
+        using Element = typename T::value_type;
+        static_assert(std::is_arithmetic_v<Element>, "only vectors of numbers or bools can be converted");
+        // elements that can not be converted are 0 (same as StringHelper::toVector)
+        return StringHelper::toVector<Element>(std::string(value), [](std::string element, Element defaultValue){ 
+            return convert<Element>(element).value_or(defaultValue); 
+        });
+    }
+    else
+    {
+        static_assert(std::is_constructible_v<T, std::string>, "the type must be a number, bool, vector of numbers, or be constructible from a std::string");
+        return T(std::string(value));
+    }
+}
+
 #endif
@@ -29,12 +29,29 @@ int main()
     std::cout << GET_FUNCTION_INFO() << std::endl;
     // TestHelperTest::test();
     // funcHelperTest::test();
+    // funcHelperTest::dynamicBenchmark();
+    // funcHelperTest::asyncBenchmark();
     EventHelperTest::test();
+    // EventHelperTest::benchmark();
+    // EventHelperTest::synchronizedBenchmark();
+    // EventHelperTest::dynamicBenchmark();
+    // EventHelperTest::teardownBenchmark();
+    // EventHelperTest::teardownCheck();
+    // EventHelperTest::parallelBenchmark();
+    // EventHelperTest::batchBenchmark();
     // StopwatchTest::test();
     // StringHelperTest::test();
     // UpdateLimiterTest::test();
     // LogTest::test();
+    // LogTest::benchmark();
+    // LogTest::threadedBenchmark();
+    // LogTest::binaryBenchmark();
+    // LogTest::rotationBenchmark();
+    // LogTest::levelBenchmark();
     // iniParserTest::test();
+    // iniParserTest::benchmark();
+    // iniParserTest::lookupBenchmark();
+    // iniParserTest::saveBenchmark();
     // TerminatingFunctionTest::test(); 
     // // live var test is put after the VarDisplay is initalized so the vars will be in the display
     VarDisplayTest::test();
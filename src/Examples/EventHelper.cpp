@@ -1,5 +1,159 @@
 #include "include/Examples/EventHelper.hpp"
 
+namespace
+{
+/// @brief the synchronized queue before it was lock free (only used to compare against)
+class LockedQueue
+{
+public:
+    void addEvent(const void* event, std::function<void()>&& func, bool removeSameEvents = false)
+    {
+        if (removeSameEvents)
+            removeEvent(event);
+        m_lock.lock();
+        m_events.emplace_back(event, func);
+        m_lock.unlock();
+    }
+
+    /// @brief events used to call this from there destructor
+    void removeEvent(const void* event)
+    {
+        m_lock.lock();
+        m_events.remove_if([event](const std::pair<const void*, std::function<void()>>& queued){ return queued.first == event; });
+        m_lock.unlock();
+    }
+
+    void update()
+    {
+        m_lock.lock();
+        for (auto& event: m_events)
+            event.second();
+        m_events.clear();
+        m_lock.unlock();
+    }
+
+private:
+    std::mutex m_lock;
+    std::list<std::pair<const void*, std::function<void()>>> m_events;
+};
+
+/// @brief an event that removes itself from the locked queue when destroyed (the same as events before the queue tracked them)
+struct LockedQueueEvent
+{
+    LockedQueueEvent(LockedQueue& queue) : queue(queue) {}
+    ~LockedQueueEvent() { queue.removeEvent(this); }
+
+    LockedQueue& queue;
+    std::function<void()> callback;
+};
+
+/// @brief creates and destroys the given number of events while another thread keeps the synchronized queue full
+/// @param addEvent called from the other thread, should queue one call that increments the given counter
+/// @param createAndDestroy called on this thread with the index of the event, should create and destroy one event
+/// @returns the average ns it took to create and destroy each event
+template <typename AddFunc, typename CreateFunc, typename UpdateFunc>
+double runTeardownStress(size_t events, const AddFunc& addEvent, const CreateFunc& createAndDestroy, const UpdateFunc& update)
+{
+    using namespace std;
+
+    // roughly how many calls are waiting in the queue between updates
+    const size_t backlog = 4096;
+    atomic<bool> stop = false;
+    atomic<size_t> called = 0;
+    thread producer([&](){
+        size_t added = 0;
+        while (!stop.load(memory_order_relaxed))
+        {
+            if (added - called.load(memory_order_relaxed) < backlog)
+            {
+                addEvent(called);
+                added++;
+            }
+            else
+                this_thread::yield();
+        }
+    });
+
+    uint64_t time = 0;
+    for (size_t i = 0; i < events; i++)
+    {
+        const auto start = chrono::steady_clock::now();
+        createAndDestroy(i);
+        time += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        // updating like a game loop would so the queue does not grow forever
+        if (i % 1024 == 0)
+            update();
+    }
+    stop = true;
+    producer.join();
+    update();
+
+    return double(time) / events;
+}
+
+/// @brief counts copies so we can check that invoking does not copy the parameters
+struct CopyCounter
+{
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter&) { copies++; }
+    CopyCounter& operator=(const CopyCounter&) { copies++; return *this; }
+    static inline size_t copies = 0;
+};
+
+/// @brief small amount of work so calling the queued events takes some time
+void simulateWork(size_t amount = 64)
+{
+    volatile size_t sum = 0;
+    for (size_t i = 0; i < amount; i++)
+        sum = sum + i;
+}
+
+/// @brief adds events from the given number of threads while this thread calls update until they are all called
+/// @param addEvent called from the producer threads, should queue one call that increments the given counter
+/// @param update called on this thread to call the queued events
+template <typename AddFunc, typename UpdateFunc>
+void runSynchronizedStress(const std::string& name, size_t producers, size_t eventsPerProducer, const AddFunc& addEvent, const UpdateFunc& update)
+{
+    using namespace std;
+    using clock = chrono::steady_clock;
+
+    size_t called = 0;
+    vector<vector<uint64_t>> latencies(producers);
+    vector<thread> threads;
+    for (size_t t = 0; t < producers; t++)
+    {
+        latencies[t].reserve(eventsPerProducer);
+        threads.emplace_back([&, t](){
+            for (size_t i = 0; i < eventsPerProducer; i++)
+            {
+                const auto start = clock::now();
+                addEvent(called);
+                latencies[t].push_back(chrono::duration_cast<chrono::nanoseconds>(clock::now() - start).count());
+            }
+        });
+    }
+
+    uint64_t drainTime = 0;
+    while (called < producers * eventsPerProducer)
+    {
+        const auto start = clock::now();
+        update();
+        drainTime += chrono::duration_cast<chrono::nanoseconds>(clock::now() - start).count();
+    }
+    for (auto& t: threads)
+        t.join();
+
+    vector<uint64_t> all;
+    for (auto& l: latencies)
+        all.insert(all.end(), l.begin(), l.end());
+    sort(all.begin(), all.end());
+    auto percentile = [&all](double p){ return all[min(all.size() - 1, size_t(p * all.size()))]; };
+
+    cout << "    " << name << ": enqueue p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99) << " ns, p99.9 " << percentile(0.999)
+         << " ns, max " << all.back() << " ns | drain " << (called * 1000.0 / max<uint64_t>(drainTime, 1)) << " million calls/s" << endl;
+}
+}
+
 void EventHelperTest::test()
 {
     using namespace std;
@@ -66,8 +220,372 @@ void EventHelperTest::test()
     // For dynamic events the bool is the last input
     // Thread safe is default to false as the events are not called immediately
 
+    // batched events collect payloads and give all of them to each callback at once when flushed (i.e. once per frame)
+    EventHelper::EventBatched<int> batchedEvent;
+    batchedEvent.connect([](std::span<const int> values){ 
+        cout << "Batched values:";
+        for (int value: values)
+            cout << " " << value;
+        cout << endl;
+    });
+    batchedEvent.push(1);
+    batchedEvent.push(2);
+    batchedEvent.push(3);
+    batchedEvent.flush();
+    // flushing with a queue moves the payloads into the queued call so pushing can continue before the queue is updated
+    EventHelper::DispatchQueue batchedQueue("Batched example");
+    batchedEvent.push(4);
+    batchedEvent.push(5);
+    batchedEvent.flush(batchedQueue);
+    batchedEvent.push(6);
+    batchedQueue.update();
+
+    // when EVENT_HELPER_STATS is defined events record how long there callbacks take
+    // the stats of every event can be seen with the "events stats" command (see Event::initCommand) or as json with Event::dumpStats
+    batchedEvent.setStatsName("Batched example");
+    #ifdef EVENT_HELPER_STATS
+    cout << "Batched event stats: " << batchedEvent.getStats().invokes << " invokes, " << batchedEvent.getStats().totalTime << " ns" << endl;
+    #endif
+
+    // Events can also be invoked on any other thread by giving a DispatchQueue instead of the bool
+    // each thread updates its own queue (the synchronized queue is just the queue named "Synchronized")
+    EventHelper::DispatchQueue workerQueue("worker");
+    // named queues can also be shared with EventHelper::DispatchQueue::get("name")
+    std::atomic<bool> calledOnWorker = false;
+    std::atomic<bool> stopWorker = false;
+    std::thread worker([&workerQueue, &stopWorker](){
+        while (!stopWorker)
+        {
+            workerQueue.update();
+            std::this_thread::yield();
+        }
+    });
+    const std::thread::id mainThread = std::this_thread::get_id();
+    EventHelper::EventDynamic<int> workerEvent;
+    workerEvent.connect([&calledOnWorker, mainThread](int value){ calledOnWorker = (std::this_thread::get_id() != mainThread); });
+    workerEvent.invoke(1, workerQueue);
+    while (workerQueue.getStats().called == 0)
+        std::this_thread::yield();
+    stopWorker = true;
+    worker.join();
+    auto stats = workerQueue.getStats();
+    cout << "Called on the worker thread: " << (calledOnWorker ? "true" : "false") << endl;
+    cout << "Worker queue stats - queued: " << stats.queued << ", called: " << stats.called << ", skipped: " << stats.skipped << ", depth: " << stats.depth << endl;
+
     // dynamic events are assigned the same as a funcDynamic
     // when invoking you must give all the inputs
     // has the same features as a normal event
+    // any number of inputs can be used (EventDynamic2-5 are the same as EventDynamic with that many inputs)
+    EventHelper::EventDynamic<int, std::string, float> dynamicEvent;
+    // callbacks take the bound inputs first and then as many of the dynamic inputs as they want (from the front)
+    dynamicEvent.connect([](const std::string& text, int i){ cout << text << i << endl; }, "Bound input then the first dynamic input: ");
+    dynamicEvent.connect([](int i, const std::string& str, float f){ cout << "All dynamic inputs: " << i << " " << str << " " << f << endl; });
+    dynamicEvent.invoke(5, "five", 5.5f);
     cout << "--- End EventHelper --- " << endl;
-}
\ No newline at end of file
+}
+void EventHelperTest::benchmark()
+{
+    using namespace std;
+
+    cout << "--- EventHelper Benchmark --- " << endl;
+    // compares invoking an event against the std::map of callbacks that events used to be stored in
+    for (size_t subscribers: {10, 1000, 100000})
+    {
+        // roughly the same number of callback calls for each test
+        const size_t invokes = std::max<size_t>(10, 10000000 / subscribers);
+        size_t counter = 0;
+
+        EventHelper::Event event;
+        std::map<size_t, std::function<void()>> callbacks;
+        for (size_t i = 0; i < subscribers; i++)
+        {
+            // mixing connects and disconnects so the callbacks are not perfectly laid out in memory
+            event.connect([&counter](){ counter++; });
+            event.disconnect(event.connectPrivate([&counter](){ counter++; }));
+            callbacks[i] = [&counter](){ counter++; };
+            callbacks[subscribers + i] = [&counter](){ counter++; };
+            callbacks.erase(subscribers + i);
+        }
+
+        timer::Stopwatch stopwatch;
+        for (size_t i = 0; i < invokes; i++)
+            event.invoke();
+        const double eventTime = stopwatch.lap<timer::ns>();
+        for (size_t i = 0; i < invokes; i++)
+        {
+            for (auto& callback: callbacks)
+                callback.second();
+        }
+        const double mapTime = stopwatch.lap<timer::ns>();
+
+        cout << subscribers << " subscribers, " << invokes << " invokes" << endl;
+        cout << "    Event:    " << eventTime / (invokes * subscribers) << " ns per callback" << endl;
+        cout << "    std::map: " << mapTime / (invokes * subscribers) << " ns per callback" << endl;
+        cout << "    (counter: " << counter << ")" << endl;
+    }
+    cout << "--- End EventHelper Benchmark --- " << endl;
+}
+
+void EventHelperTest::dynamicBenchmark()
+{
+    using namespace std;
+
+    cout << "--- EventHelper Dynamic Benchmark --- " << endl;
+
+    EventHelper::EventDynamic<CopyCounter, int> copyEvent;
+    copyEvent.connect([](const CopyCounter& counter, int i){});
+    funcHelper::funcDynamic<CopyCounter, int> copyFunc([](const CopyCounter& counter, int i){});
+    CopyCounter counter;
+    copyEvent.invoke(counter, 1);
+    copyFunc.invoke(counter, 1);
+    cout << "Parameter copies when invoking: " << CopyCounter::copies << endl;
+
+    // the time it takes to call one function with the same parameters through each way of storing it
+    const size_t invokes = 20000000;
+    volatile size_t sink = 0;
+    const string str = "string";
+    auto function = [&sink](int i, double d, const string& s){ sink = sink + i + size_t(d) + s.size(); };
+
+    timer::Stopwatch stopwatch;
+    for (size_t i = 0; i < invokes; i++)
+        std::invoke(function, int(i), 1.0, str);
+    const double directTime = stopwatch.lap<timer::ns>();
+
+    std::function<void(int, double, const string&)> stdFunction = function;
+    stopwatch.lap<timer::ns>();
+    for (size_t i = 0; i < invokes; i++)
+        std::invoke(stdFunction, int(i), 1.0, str);
+    const double stdFunctionTime = stopwatch.lap<timer::ns>();
+
+    funcHelper::funcDynamic<int, double, string> dynamicFunc(function);
+    stopwatch.lap<timer::ns>();
+    for (size_t i = 0; i < invokes; i++)
+        dynamicFunc.invoke(int(i), 1.0, str);
+    const double funcTime = stopwatch.lap<timer::ns>();
+
+    EventHelper::EventDynamic<int, double, string> event;
+    event.connect(function);
+    stopwatch.lap<timer::ns>();
+    for (size_t i = 0; i < invokes; i++)
+        event.invoke(int(i), 1.0, str);
+    const double eventTime = stopwatch.lap<timer::ns>();
+
+    cout << invokes << " invokes with 3 parameters" << endl;
+    cout << "    std::invoke (inlined): " << directTime / invokes << " ns per invoke" << endl;
+    cout << "    std::function:         " << stdFunctionTime / invokes << " ns per invoke" << endl;
+    cout << "    funcDynamic:           " << funcTime / invokes << " ns per invoke" << endl;
+    cout << "    EventDynamic:          " << eventTime / invokes << " ns per invoke (1 callback)" << endl;
+    cout << "--- End EventHelper Dynamic Benchmark --- " << endl;
+}
+
+void EventHelperTest::synchronizedBenchmark()
+{
+    using namespace std;
+
+    cout << "--- EventHelper Synchronized Benchmark --- " << endl;
+    const size_t eventsPerProducer = 200000;
+    for (size_t producers: {1, 2, 4, 8})
+    {
+        cout << producers << " producer threads, " << eventsPerProducer << " events each" << endl;
+
+        LockedQueue lockedQueue;
+        runSynchronizedStress("Locked list", producers, eventsPerProducer, 
+            [&lockedQueue](size_t& called){ lockedQueue.addEvent(nullptr, [&called](){ called++; simulateWork(); }); },
+            [&lockedQueue](){ lockedQueue.update(); });
+
+        size_t* counter = nullptr;
+        EventHelper::Event event;
+        event.connect([&counter](){ (*counter)++; simulateWork(); });
+        runSynchronizedStress("Lock free  ", producers, eventsPerProducer, 
+            [&event, &counter](size_t& called){ counter = &called; event.invoke(true); },
+            [](){ EventHelper::Event::Synchronized::update(); });
+    }
+    cout << "--- End EventHelper Synchronized Benchmark --- " << endl;
+}
+
+void EventHelperTest::teardownBenchmark()
+{
+    using namespace std;
+
+    cout << "--- EventHelper Teardown Benchmark --- " << endl;
+    const size_t events = 1000000;
+    // every 16th event is queued before being destroyed, the rest are never queued
+    cout << events << " events created and destroyed while another thread keeps about 4096 synchronized invokes queued" << endl;
+
+    LockedQueue lockedQueue;
+    const double lockedTime = runTeardownStress(events, 
+        [&lockedQueue](atomic<size_t>& called){ lockedQueue.addEvent(nullptr, [&called](){ called++; }); },
+        [&lockedQueue](size_t i){ 
+            LockedQueueEvent event(lockedQueue);
+            event.callback = [](){};
+            if (i % 16 == 0)
+                lockedQueue.addEvent(&event, [&event](){ event.callback(); }, true);
+        },
+        [&lockedQueue](){ lockedQueue.update(); });
+
+    atomic<size_t>* counter = nullptr;
+    EventHelper::Event producerEvent;
+    producerEvent.connect([&counter](){ (*counter)++; });
+    const double eventTime = runTeardownStress(events, 
+        [&producerEvent, &counter](atomic<size_t>& called){ counter = &called; producerEvent.invoke(true); },
+        [](size_t i){
+            EventHelper::Event event;
+            event.connect([](){});
+            if (i % 16 == 0)
+                event.invoke(true, true);
+        },
+        [](){ EventHelper::Event::Synchronized::update(); });
+
+    cout << "    Scanning locked list: " << lockedTime << " ns per event" << endl;
+    cout << "    Event:                " << eventTime << " ns per event" << endl;
+    cout << "--- End EventHelper Teardown Benchmark --- " << endl;
+}
+
+void EventHelperTest::teardownCheck()
+{
+    using namespace std;
+
+    cout << "--- EventHelper Teardown Check --- " << endl;
+    const size_t events = 1000;
+    cout << events << " events destroyed while another thread is calling their queued invokes" << endl;
+
+    EventHelper::DispatchQueue queue("teardown check");
+    atomic<bool> stop = false;
+    thread worker([&queue, &stop](){
+        while (!stop)
+            queue.update();
+    });
+
+    atomic<bool> started = false;
+    atomic<bool> destroying = false;
+    atomic<bool> destroyed = false;
+    atomic<size_t> violations = 0;
+    for (size_t i = 0; i < events; i++)
+    {
+        started = false;
+        destroying = false;
+        destroyed = false;
+        auto event = make_unique<EventHelper::Event>();
+        event->connect([&started, &destroying, &destroyed, &violations](){
+            started = true;
+            // making sure the event is being destroyed while this call is still running
+            while (!destroying)
+                this_thread::yield();
+            this_thread::sleep_for(chrono::microseconds(50));
+            // the event is only destroyed once this call returns so this should never be true
+            if (destroyed)
+                violations++;
+        });
+        for (size_t call = 0; call < 8; call++)
+            event->invoke(queue);
+        while (!started)
+            this_thread::yield();
+        destroying = true;
+        event.reset();
+        destroyed = true;
+    }
+    stop = true;
+    worker.join();
+
+    cout << "    Calls that used a destroyed event: " << violations << endl;
+    cout << "--- End EventHelper Teardown Check --- " << endl;
+}
+
+void EventHelperTest::parallelBenchmark()
+{
+    using namespace std;
+
+    cout << "--- EventHelper Parallel Benchmark --- " << endl;
+    ThreadPool& pool = ThreadPool::getShared();
+    cout << "Shared pool threads: " << pool.getThreadCount() << " (+ the invoking thread)" << endl;
+
+    // every callback is called exactly once
+    {
+        EventHelper::EventDynamic<int> event;
+        vector<atomic<int>> calls(1000);
+        for (size_t i = 0; i < calls.size(); i++)
+            event.connect([&calls, i](int amount){ calls[i] += amount; });
+        event.invokeParallel(1, 16);
+        bool once = all_of(calls.begin(), calls.end(), [](const atomic<int>& count){ return count == 1; });
+        cout << "Every callback called once: " << (once ? "true" : "false") << endl;
+    }
+
+    // amount of work is the number of loops done in simulateWork per callback
+    for (size_t work: {100, 1000, 10000})
+    {
+        for (size_t callbacks: {16, 256, 4096})
+        {
+            EventHelper::Event event;
+            for (size_t i = 0; i < callbacks; i++)
+                event.connect([work](){ simulateWork(work); });
+
+            const size_t invokes = max<size_t>(1, 4000000 / (callbacks * work));
+            // cheap callbacks are given out in larger groups so taking them is not most of the time
+            const size_t grainSize = max<size_t>(1, 2000 / work);
+
+            timer::Stopwatch stopwatch;
+            for (size_t i = 0; i < invokes; i++)
+                event.invoke();
+            const double sequentialTime = stopwatch.lap<timer::ns>() / invokes;
+            for (size_t i = 0; i < invokes; i++)
+                event.invokeParallel(grainSize);
+            const double parallelTime = stopwatch.lap<timer::ns>() / invokes;
+
+            cout << "    " << callbacks << " callbacks, " << work << " work, grain " << grainSize << ": sequential " << sequentialTime / 1000 << " us, parallel " 
+                 << parallelTime / 1000 << " us, speedup " << sequentialTime / parallelTime << "x" << endl;
+        }
+    }
+    cout << "--- End EventHelper Parallel Benchmark --- " << endl;
+}
+
+void EventHelperTest::batchBenchmark()
+{
+    using namespace std;
+
+    cout << "--- EventHelper Batch Benchmark --- " << endl;
+    struct Moved
+    {
+        size_t entity;
+        float x, y;
+    };
+
+    for (size_t subscribers: {1, 8, 64})
+    {
+        const size_t payloads = 50000;
+        const size_t frames = max<size_t>(1, 64 / subscribers);
+        volatile float sink = 0;
+
+        EventHelper::EventDynamic<Moved> event;
+        EventHelper::EventBatched<Moved> batchedEvent;
+        for (size_t i = 0; i < subscribers; i++)
+        {
+            event.connect([&sink](const Moved& moved){ sink = sink + moved.x; });
+            batchedEvent.connect([&sink](std::span<const Moved> moved){ 
+                float sum = 0;
+                for (const Moved& m: moved)
+                    sum += m.x;
+                sink = sink + sum;
+            });
+        }
+
+        timer::Stopwatch stopwatch;
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            for (size_t i = 0; i < payloads; i++)
+                event.invoke({i, float(i), float(frame)});
+        }
+        const double eventTime = stopwatch.lap<timer::ns>();
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            for (size_t i = 0; i < payloads; i++)
+                batchedEvent.push({i, float(i), float(frame)});
+            batchedEvent.flush();
+        }
+        const double batchedTime = stopwatch.lap<timer::ns>();
+
+        cout << subscribers << " subscribers, " << payloads << " payloads per frame" << endl;
+        cout << "    EventDynamic:  " << eventTime / (frames * payloads) << " ns per payload" << endl;
+        cout << "    EventBatched:  " << batchedTime / (frames * payloads) << " ns per payload" << endl;
+    }
+    cout << "--- End EventHelper Batch Benchmark --- " << endl;
+}
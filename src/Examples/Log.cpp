@@ -1,4 +1,14 @@
 #include "include/Examples/Log.hpp"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <filesystem>
 
 void LogTest::test()
 {
@@ -6,4 +16,322 @@ void LogTest::test()
     // To create a log you use the command CreateLog
     Log::add(Log::Type::Debug, "Creating a log");
     // When it writes the String to the file it will include the infomation about which Log type it is and the time is was added
+
+    // In async mode logs are written to the file by a background thread so adding one does not wait on the file
+    Log::setAsync(true);
+    Log::add(Log::Type::Info, "Written by the background thread");
+    // flush waits until everything added before it is in the file
+    Log::flush();
+    Log::setAsync(false);
+
+    // Binary logs only store the arguments, the format is stored once and "{}" is replaced when decoding (see the log-decoder make target)
+    LOG_BINARY(Log::Type::Info, "Binary log with {} arguments: {}", 2, "the second one");
+
+    // The time of each log has the same layout as std::ctime, microseconds can be added after the seconds
+    Log::setPrintMicroseconds(true);
+    Log::add(Log::Type::Info, "This log has microseconds");
+    Log::setPrintMicroseconds(false);
+
+    // Logs can also have the time since the program started (in nanoseconds from a monotonic clock) so they can be lined up with other timings
+    Log::setPrintMonotonicTime(true);
+    Log::add(Log::Type::Info, "This log was added " + std::to_string(Log::getMonotonicTime().count()) + " ns after the program started");
+    Log::setPrintMonotonicTime(false);
+
+    // In flight recorder mode logs are also copied into a memory mapped file which survives crashes, if the program crashed the logs in it are added to the log file the next time it is turned on
+    Log::setFlightRecorder(true);
+    Log::add(Log::Type::Info, "In the log file and the flight recorder");
+    Log::setFlightRecorder(false);
+
+    // The LOG macros only build the message if the type is enabled, types below LOG_MIN_LEVEL are not compiled in at all
+    Log::setMinLevel(Log::Type::Info);
+    LOG_DEBUG("Not built or written " + std::to_string(1));
+    LOG_INFO("Built and written " + std::to_string(2));
+    Log::setMinLevel(Log::Type::Debug);
+    // At most 5 logs a second (with bursts of 10) from this line, the rest are dropped and counted
+    for (int i = 0; i < 100; i++)
+        LOG_RATE_LIMITED(Log::Type::Warning, 5, 10, "Rate limited log " + std::to_string(i));
+}
+
+void LogTest::benchmark()
+{
+    using namespace std;
+
+    cout << "--- Log Benchmark --- " << endl;
+
+    const size_t logs = 20000;
+    // returns the time each add took (sorted) and the total time including writing everything to the file
+    auto timeAdds = [&](){
+        vector<uint64_t> times(logs);
+        const auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < logs; i++)
+        {
+            const auto addStart = chrono::steady_clock::now();
+            Log::add(Log::Type::Debug, "Benchmark log number " + to_string(i));
+            times[i] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - addStart).count();
+        }
+        Log::flush();
+        const auto total = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        sort(times.begin(), times.end());
+        return make_pair(times, double(total) / logs);
+    };
+    auto print = [&](const string& name, const pair<vector<uint64_t>, double>& result){
+        const vector<uint64_t>& times = result.first;
+        cout << "    " << name << " - p50: " << times[logs / 2] << " ns, p99: " << times[logs * 99 / 100] << " ns, p99.9: " << times[logs * 999 / 1000] 
+             << " ns, max: " << times.back() << " ns, total: " << result.second << " ns per log" << endl;
+    };
+
+    cout << logs << " logs, time the caller spends in Log::add" << endl;
+    Log::setAsync(false);
+    print("Sync                   ", timeAdds());
+    Log::setAsync(true, 8192, Log::OverflowPolicy::Block);
+    print("Async (block)          ", timeAdds());
+    // the buffer is smaller than the number of logs so some of them are dropped
+    const size_t dropped = Log::getDroppedCount();
+    Log::setAsync(true, 1024, Log::OverflowPolicy::DropAndCount);
+    print("Async (drop, 1024 logs)", timeAdds());
+    cout << "    Dropped: " << Log::getDroppedCount() - dropped << endl;
+    Log::setAsync(false);
+    Log::setFlightRecorder(true);
+    print("Sync + flight recorder ", timeAdds());
+    // the ring only has the newest logs that fit
+    ifstream ring(Log::getFlightRecorderPath(), ios::binary);
+    stringstream recovered;
+    Log::recoverFlightRecorder(ring, recovered);
+    size_t lines = 0;
+    string line, lastLine;
+    while (getline(recovered, line))
+    {
+        lines++;
+        lastLine = line;
+    }
+    cout << "    Recovered " << lines << " lines, last: " << lastLine.substr(lastLine.find("] [") + 2) << endl;
+    Log::setFlightRecorder(false);
+
+    cout << "--- End Log Benchmark --- " << endl;
+}
+
+void LogTest::threadedBenchmark()
+{
+    using namespace std;
+
+    cout << "--- Log Threaded Benchmark --- " << endl;
+
+    const size_t logsPerThread = 5000;
+    // returns the logs added per second over all of the threads
+    auto run = [&](size_t threadCount){
+        vector<thread> threads;
+        const auto start = chrono::steady_clock::now();
+        for (size_t t = 0; t < threadCount; t++)
+            threads.emplace_back([t, logsPerThread]{
+                for (size_t i = 0; i < logsPerThread; i++)
+                    Log::add(Log::Type::Debug, "Thread " + to_string(t) + " log " + to_string(i));
+            });
+        for (thread& thread: threads)
+            thread.join();
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        Log::flush();
+        return threadCount * logsPerThread / seconds;
+    };
+
+    cout << logsPerThread << " logs per thread, hardware threads: " << thread::hardware_concurrency() << endl;
+    for (bool async: {false, true})
+    {
+        Log::setAsync(async);
+        cout << (async ? "    Async (per thread buffers)" : "    Sync (file lock)          ");
+        for (size_t threadCount: {1, 2, 4, 8, 16})
+            cout << " - " << threadCount << " threads: " << size_t(run(threadCount) / 1000) << "k logs/s";
+        cout << endl;
+    }
+    Log::setAsync(false);
+
+    // every line has to be whole and the logs of each thread have to be in the order they where added
+    ifstream file(Log::getFilePath());
+    map<size_t, size_t> nextLog;
+    size_t lines = 0, tornLines = 0, outOfOrder = 0;
+    string line;
+    while (getline(file, line))
+    {
+        const size_t start = line.find("] -- Thread ");
+        if (start == string::npos)
+            continue;
+        size_t thread, log;
+        char end;
+        if (line[0] != '[' || sscanf(line.c_str() + start, "] -- Thread %zu log %zu%c", &thread, &log, &end) != 2)
+        {
+            tornLines++;
+            continue;
+        }
+        // the same thread ids are used for every run so the log count restarts at 0
+        if (log != 0 && log != nextLog[thread])
+            outOfOrder++;
+        nextLog[thread] = log + 1;
+        lines++;
+    }
+    cout << "    Lines checked: " << lines << ", torn lines: " << tornLines << ", out of order: " << outOfOrder << endl;
+
+    cout << "--- End Log Threaded Benchmark --- " << endl;
+}
+
+void LogTest::binaryBenchmark()
+{
+    using namespace std;
+
+    cout << "--- Log Binary Benchmark --- " << endl;
+
+    const size_t logs = 20000;
+    const string zone = "Forest";
+    // returns the ns spent per log by the caller and the bytes per log written to the given file
+    auto timeLogs = [&](const auto& addLog, const auto& getPath){
+        Log::flush();
+        const uintmax_t startSize = getPath().empty() ? 0 : filesystem::file_size(getPath());
+        const auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < logs; i++)
+            addLog(i, float(i) * 0.5f, float(i) * 2.f);
+        const auto time = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        Log::flush();
+        return make_pair(double(time) / logs, double(filesystem::file_size(getPath()) - startSize) / logs);
+    };
+    auto addText = [&](size_t id, float x, float y){
+        Log::add(Log::Type::Info, "Player " + to_string(id) + " moved to " + to_string(x) + ", " + to_string(y) + " in " + zone);
+    };
+    auto addBinary = [&](size_t id, float x, float y){
+        LOG_BINARY(Log::Type::Info, "Player {} moved to {}, {} in {}", id, x, y, zone);
+    };
+
+    cout << logs << " logs with 4 arguments" << endl;
+    for (bool async: {false, true})
+    {
+        Log::setAsync(async);
+        const auto text = timeLogs(addText, Log::getFilePath);
+        const auto binary = timeLogs(addBinary, Log::getBinaryFilePath);
+        cout << "    " << (async ? "Async" : "Sync ") << " - text: " << text.first << " ns, " << text.second << " bytes per log - binary: " 
+             << binary.first << " ns, " << binary.second << " bytes per log" << endl;
+    }
+    Log::setAsync(false);
+
+    // the decoded binary log should be the same as the text log
+    ifstream binaryFile(Log::getBinaryFilePath(), ios::binary);
+    stringstream decoded;
+    const bool valid = Log::decodeBinary(binaryFile, decoded);
+    string line, lastLine;
+    while (getline(decoded, line))
+        lastLine = line;
+    cout << "    Decoded (valid: " << valid << "): " << lastLine.substr(lastLine.find(']') + 2) << endl;
+    cout << "    Expected:           [Info] -- Player " << logs - 1 << " moved to " << to_string((logs - 1) * 0.5f) << ", " << to_string((logs - 1) * 2.f) << " in " << zone << endl;
+
+    cout << "--- End Log Binary Benchmark --- " << endl;
+}
+
+void LogTest::rotationBenchmark()
+{
+    using namespace std;
+
+    cout << "--- Log Rotation Benchmark --- " << endl;
+
+    const string previousFolder = Log::getLogFolder();
+    const string folder = previousFolder + "/RotationBenchmark";
+    filesystem::remove_all(folder);
+    filesystem::create_directories(folder);
+
+    // the first file is named with the current date
+    Log::setLogFolder(folder);
+    Log::add(Log::Type::Info, "Finding the date");
+    const string date = filesystem::path(Log::getFilePath()).stem().string();
+
+    // old logs from earlier launches today, the first log has to find the next free name
+    const size_t oldLogs = 2000;
+    for (size_t i = 0; i < oldLogs; i++)
+        ofstream(folder + "/" + date + "-" + to_string(i) + ".log") << "old log\n";
+
+    // checking if each name exists until a free one is found
+    auto start = chrono::steady_clock::now();
+    size_t index = 0;
+    while (filesystem::exists(folder + "/" + date + "-" + to_string(index) + ".log"))
+        index++;
+    const auto probeTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    // the folder is scanned once when a new file is opened
+    start = chrono::steady_clock::now();
+    Log::setLogFolder(folder);
+    Log::add(Log::Type::Info, "First log");
+    cout << "Opening a log with " << oldLogs << " old logs in the folder: " << chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count() 
+         << " us (probing each name: " << probeTime << " us)" << endl;
+    cout << "    Opened: " << filesystem::path(Log::getFilePath()).filename().string() << endl;
+
+    const uintmax_t maxFile = 64 * 1024, maxFolder = 512 * 1024;
+    Log::setMaxFileSize(maxFile);
+    Log::setMaxFolderSize(maxFolder);
+    
+    const size_t logs = 50000;
+    for (bool async: {false, true})
+    {
+        Log::setAsync(async);
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < logs; i++)
+            Log::add(Log::Type::Info, "Rotated log " + to_string(i));
+        Log::flush();
+        const auto time = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / logs;
+
+        size_t files = 0;
+        uintmax_t size = 0, largest = 0;
+        for (const auto& entry: filesystem::directory_iterator(folder))
+        {
+            files++;
+            size += entry.file_size();
+            largest = max(largest, entry.file_size());
+        }
+        // a file can go over the limit by the logs that where written together with the one that filled it
+        cout << "    " << (async ? "Async" : "Sync ") << " - " << time << " ns per log, " << files << " files, " << size / 1024 << " KiB in the folder (limit " 
+             << maxFolder / 1024 << " KiB), largest file " << largest / 1024 << " KiB (limit " << maxFile / 1024 << " KiB)" << endl;
+    }
+    Log::setAsync(false);
+
+    Log::setMaxFileSize(0);
+    Log::setMaxFolderSize(0);
+    Log::setLogFolder(previousFolder);
+    filesystem::remove_all(folder);
+
+    cout << "--- End Log Rotation Benchmark --- " << endl;
+}
+
+void LogTest::levelBenchmark()
+{
+    using namespace std;
+
+    cout << "--- Log Level Benchmark --- " << endl;
+
+    const size_t logs = 1000000;
+    size_t built = 0;
+    auto message = [&](size_t i){
+        built++;
+        return "Debug value " + to_string(i);
+    };
+    auto timeLogs = [&](auto&& addLog){
+        built = 0;
+        const auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < logs; i++)
+            addLog(i);
+        Log::flush();
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / double(logs);
+    };
+
+    Log::setMinLevel(Log::Type::Info);
+    double time = timeLogs([&](size_t i){ Log::add(Log::Type::Debug, message(i)); });
+    cout << "Disabled debug log with add: " << time << " ns, messages built: " << built << endl;
+    time = timeLogs([&](size_t i){ LOG_DEBUG(message(i)); });
+    cout << "Disabled debug log with LOG_DEBUG: " << time << " ns, messages built: " << built << endl;
+    Log::setMinLevel(Log::Type::Debug);
+
+    Log::setAsync(true);
+    time = timeLogs([&](size_t i){ LOG_DEBUG(message(i)); });
+    cout << "Enabled async debug log with LOG_DEBUG: " << time << " ns, messages built: " << built << endl;
+    Log::setAsync(false);
+
+    // a hot loop that would write a log every iteration
+    const size_t start = std::filesystem::file_size(Log::getFilePath());
+    time = timeLogs([&](size_t i){ LOG_RATE_LIMITED(Log::Type::Warning, 100, 10, message(i)); });
+    cout << "Rate limited log (100 per second, bursts of 10): " << time << " ns, messages built: " << built << " of " << logs 
+         << ", bytes written: " << std::filesystem::file_size(Log::getFilePath()) - start << endl;
+
+    cout << "--- End Log Level Benchmark --- " << endl;
 }
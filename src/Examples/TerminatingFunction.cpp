@@ -16,7 +16,7 @@ void TerminatingFunctionTest::test()
     TerminatingFunction::Add([](){ cout << "Also runs only once" << endl; });
     
     // to remove a function you need to store its id when added
-    std::string temp = TerminatingFunction::Add([](){ cout << "This never runs" << endl; });
+    funcHelper::funcID temp = TerminatingFunction::Add([](){ cout << "This never runs" << endl; });
     TerminatingFunction::forceRemove(temp);
 
     // this would clear all current functions
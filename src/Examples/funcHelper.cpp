@@ -1,4 +1,108 @@
 #include "include/Examples/funcHelper.hpp"
+#include <cstdlib>
+#include <new>
+#include <memory>
+
+std::atomic<size_t> funcHelperTest::allocations = 0;
+
+// counting every heap allocation so we can check that funcs and events dont allocate
+// the replacements are never inlined, otherwise gcc sees std::free called on a pointer from operator new (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+#define FUNC_HELPER_TEST_NOINLINE __attribute__((noinline))
+#else
+#define FUNC_HELPER_TEST_NOINLINE
+#endif
+
+FUNC_HELPER_TEST_NOINLINE void* operator new(std::size_t size)
+{
+    funcHelperTest::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+FUNC_HELPER_TEST_NOINLINE void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+FUNC_HELPER_TEST_NOINLINE void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+/// @brief counts how often it is copied and moved
+struct CopyMoveCounter
+{
+    CopyMoveCounter() = default;
+    CopyMoveCounter(const CopyMoveCounter&) { copies++; }
+    CopyMoveCounter(CopyMoveCounter&&) noexcept { moves++; }
+    CopyMoveCounter& operator=(const CopyMoveCounter&) { copies++; return *this; }
+    CopyMoveCounter& operator=(CopyMoveCounter&&) noexcept { moves++; return *this; }
+
+    static void reset() { copies = 0; moves = 0; }
+    static inline size_t copies = 0;
+    static inline size_t moves = 0;
+};
+
+/// @brief the way dynamic funcs passed parameters before (only used to compare against)
+/// @note every invoke had to take the same global lock since the parameters where stored in one global deque
+class LockedDynamic
+{
+public:
+    LockedDynamic(const std::function<void(int, int)>& function) : m_function([function]{ function(*static_cast<const int*>(m_parameters[0]), *static_cast<const int*>(m_parameters[1])); }) {}
+
+    void invoke(int param, int param2)
+    {
+        m_lock.lock();
+        m_parameters[0] = &param;
+        m_parameters[1] = &param2;
+        m_function();
+        m_lock.unlock();
+    }
+
+private:
+    std::function<void()> m_function;
+    static std::deque<const void*> m_parameters;
+    static std::mutex m_lock;
+};
+
+std::deque<const void*> LockedDynamic::m_parameters(2);
+std::mutex LockedDynamic::m_lock;
+
+/// @brief invokes from the given number of threads (each with its own function)
+/// @returns million invokes per second over all the threads
+template <typename MakeFunc>
+double runDynamicThreads(size_t threads, size_t invokes, const MakeFunc& makeFunc)
+{
+    using namespace std;
+
+    vector<size_t> sums(threads * 8, 0); // spaced out so threads dont share a cache line
+    vector<thread> workers;
+    const auto start = chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t](){
+            size_t& sum = sums[t * 8];
+            auto function = makeFunc(sum);
+            for (size_t i = 0; i < invokes; i++)
+                function.invoke(int(i), 1);
+        });
+    }
+    for (auto& worker: workers)
+        worker.join();
+    const auto time = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+    size_t total = 0;
+    for (size_t t = 0; t < threads; t++)
+        total += sums[t * 8];
+    if (total != threads * invokes)
+        cout << "    Wrong number of calls: " << total << endl;
+    return threads * invokes * 1000.0 / max<int64_t>(time, 1);
+}
+}
 
 void funcHelperTest::test()
 {
@@ -55,6 +159,10 @@ void funcHelperTest::test()
     //      - No matter what you input into the function it will have the same name
     //      - The id is given base on the give functions input (NOT what you gave as input but what the function requires i.e. int, float) and which class it was created in
     //      - Lambda functions will never have the same id even if they are the exact same
+    // type ids are only for displaying, to tell functions apart use the id which is unique for every set function (and kept by copies)
+    func<> copy = function;
+    cout << "Copy has the same id: " << (copy.getID() == function.getID()) << ", new function has the same id: " 
+         << (func<>([](){}).getID() == function.getID()) << endl;
 
     //* now onto dynamic functions
     // You have the option between a function that takes in 1-5 vars which are dynamic and an infinite amount of static vars (set at creation)
@@ -74,4 +182,177 @@ void funcHelperTest::test()
     // - you can either use the dynamic inputs or not
     // - you have to input them when calling the function
     // - you can use only some of the dynamic inputs
+
+    //* allocation free storage
+    // funcs and events store the function inside of the object (funcHelper::inplaceFunc) where std::function would heap allocate most bound functions
+    // functions bigger than FUNC_HELPER_INPLACE_CAPACITY bytes are still heap allocated (define FUNC_HELPER_INPLACE_NO_HEAP to make that a compile error instead)
+    EventHelper::Event event;
+    // the first connects allocate the space for the callbacks (the space is kept after disconnecting)
+    for (int i = 0; i < 8; i++)
+        event.connect([](){});
+    event.disconnectAll();
+    size_t startAllocations = funcHelperTest::allocations.load(std::memory_order_relaxed);
+    function.setFunction(&testingClass::function2, &temp, 1);
+    function.setFunction([&temp](int i){ temp.function2(i); }, 2);
+    dynFunction.setFunction([&temp](int i, const std::string& str){ temp.function2(i); }, 3);
+    event.connect(&testingClass::function2, &temp, 4);
+    event.connect([&temp, &function, &rtnFunction](){ temp.function(); function(); rtnFunction(); });
+    cout << "Heap allocations when setting functions and connecting to events: " << funcHelperTest::allocations.load(std::memory_order_relaxed) - startAllocations << endl;
+    
+    // std::function does allocate for the same functions
+    startAllocations = funcHelperTest::allocations.load(std::memory_order_relaxed);
+    std::function<void()> stdFunction = std::bind(&testingClass::function2, &temp, 4);
+    stdFunction = [&temp, &function, &rtnFunction](){ temp.function(); function(); rtnFunction(); };
+    cout << "Heap allocations when assigning the same kind of functions to std::function: " << funcHelperTest::allocations.load(std::memory_order_relaxed) - startAllocations << endl;
+
+    //* bound arguments
+    // bound arguments (and the function) are moved in when given as rvalues and copied once otherwise
+    CopyMoveCounter counter;
+    CopyMoveCounter::reset();
+    function.setFunction([](const CopyMoveCounter&){}, counter);
+    cout << "Binding an lvalue - copies: " << CopyMoveCounter::copies << ", moves: " << CopyMoveCounter::moves << endl;
+    CopyMoveCounter::reset();
+    function.setFunction([](const CopyMoveCounter&){}, CopyMoveCounter());
+    dynFunction.setFunction([](const CopyMoveCounter&, const std::string&){}, CopyMoveCounter());
+    event.connect([](const CopyMoveCounter&){}, CopyMoveCounter());
+    cout << "Binding rvalues to a func, funcDynamic, and event - copies: " << CopyMoveCounter::copies << ", moves: " << CopyMoveCounter::moves << endl;
+
+    // mutable lambdas (and other callables with a non const call operator) keep their state between calls
+    func<int> counterFunction([count = 0]() mutable { return ++count; });
+    counterFunction();
+    funcDynamic<int> mutableDynamic([total = 0](int value) mutable { total += value; cout << "Mutable dynamic total: " << total << endl; });
+    mutableDynamic(2);
+    mutableDynamic(3);
+    event.disconnectAll();
+    event.connect([calls = 0]() mutable { calls++; cout << "Mutable callback called " << calls << " times" << endl; });
+    event.invoke();
+    event.invoke();
+    cout << "Mutable lambda called twice: " << counterFunction() << endl;
+
+    // funcs are copyable so they only take copyable functions and bound arguments (binding a std::unique_ptr to a func does not compile)
+    // funcMoveOnly and funcDynamicMoveOnly can not be copied (or invoked async) but take move only functions and bound arguments
+    funcMoveOnly<int> uniqueFunction([](const std::unique_ptr<int>& value){ return *value; }, std::make_unique<int>(5));
+    cout << "Function with a move only bound argument: " << uniqueFunction() << endl;
+    funcMoveOnly<int> movedFunction = std::move(uniqueFunction);
+    cout << "Moved function: " << movedFunction() << ", moved from is valid: " << uniqueFunction.isValid() << endl;
+    funcDynamicMoveOnly<int> uniqueDynamic([](std::unique_ptr<int>& total, int value){ *total += value; cout << "Move only dynamic total: " << *total << endl; }, std::make_unique<int>(0));
+    uniqueDynamic(2);
+    uniqueDynamic(3);
+
+    //* async invokes
+    // funcs can be invoked on a thread pool (the shared one by default, see ThreadPool::setSharedThreadCount) and chained with "then"
+    func<int> asyncFunction([](int a, int b){ return a + b; }, 2, 3);
+    asyncResult<int> asyncSum = asyncFunction.invokeAsync().then([](int sum){ return sum * 2; });
+    cout << "Async result: " << asyncSum.get() << endl;
+    // dynamic funcs copy the parameters until they are called
+    funcDynamic<std::string> asyncPrint([](const std::string& str){ cout << str << endl; });
+    asyncPrint.invokeAsync("Printed from the thread pool").get();
+    // invokes (and there continuations) that have not started yet can be cancelled
+    cancelToken token;
+    token.cancel();
+    asyncResult<void> cancelled = asyncFunction.invokeAsync(token).then([](int){ cout << "This is never printed" << endl; });
+    cancelled.wait();
+    cout << "Cancelled before starting: " << cancelled.isCancelled() << endl;
+
+    //* memoized funcs
+    // pure functions can cache there results based on the parameters (least recently used are removed first, see setCapacity and setTimeToLive)
+    size_t calls = 0;
+    funcMemoized<int, int> square([&calls](int value){ calls++; return value * value; });
+    square.setCapacity(2);
+    cout << "Memoized results: " << square(3) << " " << square(3) << " " << square(4) << " " << square(5) << " " << square(3) << endl;
+    funcMemoized<int, int>::Stats stats = square.getStats();
+    cout << "Memoized calls: " << calls << ", hits: " << stats.hits << ", misses: " << stats.misses << ", evictions: " << stats.evictions << endl;
+}
+
+void funcHelperTest::dynamicBenchmark()
+{
+    using namespace std;
+    using namespace funcHelper;
+
+    cout << "--- funcHelper Dynamic Benchmark --- " << endl;
+
+    // parameters only live for the invoke that they are given to so invoking inside of an invoke does not overwrite them
+    funcDynamic2<int, int> recursive;
+    recursive.setFunction([&recursive](int depth, int value){
+        if (depth > 0)
+            recursive.invoke(depth - 1, value * 2);
+        cout << value << " ";
+    });
+    cout << "Reentrant invoke (expected 8 4 2 1): ";
+    recursive.invoke(3, 1);
+    cout << endl;
+
+    const size_t invokes = 2000000;
+    const size_t maxThreads = max<size_t>(thread::hardware_concurrency(), 4);
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        cout << threads << " threads, " << invokes << " invokes each" << endl;
+        double locked = runDynamicThreads(threads, invokes, [](size_t& sum){ 
+            return LockedDynamic([&sum](int param, int param2){ sum += param2; }); 
+        });
+        double dynamic = runDynamicThreads(threads, invokes, [](size_t& sum){ 
+            return funcDynamic2<int, int>([&sum](int param, int param2){ sum += param2; }); 
+        });
+        cout << "    Global parameters: " << locked << " million invokes/s" << endl;
+        cout << "    funcDynamic2:      " << dynamic << " million invokes/s" << endl;
+    }
+
+    cout << "--- End funcHelper Dynamic Benchmark --- " << endl;
+}
+
+void funcHelperTest::asyncBenchmark()
+{
+    using namespace std;
+    using namespace funcHelper;
+
+    cout << "--- funcHelper Async Benchmark --- " << endl;
+
+    const size_t tasks = 2000;
+    atomic<size_t> calls = 0;
+    func<size_t> function([&calls]{ return calls.fetch_add(1, memory_order_relaxed); });
+    auto timeTasks = [&](const auto& run){
+        calls = 0;
+        const auto start = chrono::steady_clock::now();
+        run();
+        const auto time = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        if (calls != tasks)
+            cout << "    Wrong number of calls: " << calls << endl;
+        return double(time) / tasks;
+    };
+
+    // waiting for each task before starting the next one (latency)
+    const double threadLatency = timeTasks([&]{
+        for (size_t i = 0; i < tasks; i++)
+            std::thread([&function]{ function(); }).join();
+    });
+    const double asyncLatency = timeTasks([&]{
+        for (size_t i = 0; i < tasks; i++)
+            function.invokeAsync().get();
+    });
+
+    // starting every task then waiting for all of them (throughput)
+    const double threadThroughput = timeTasks([&]{
+        vector<thread> threads;
+        for (size_t i = 0; i < tasks; i++)
+            threads.emplace_back([&function]{ function(); });
+        for (thread& thread: threads)
+            thread.join();
+    });
+    ThreadPool::getShared().resetStats();
+    const double asyncThroughput = timeTasks([&]{
+        vector<asyncResult<size_t>> results;
+        for (size_t i = 0; i < tasks; i++)
+            results.emplace_back(function.invokeAsync());
+        for (const asyncResult<size_t>& result: results)
+            result.wait();
+    });
+    const ThreadPool::Stats stats = ThreadPool::getShared().getStats();
+
+    cout << tasks << " tasks, shared pool threads: " << ThreadPool::getShared().getThreadCount() << endl;
+    cout << "    One at a time - thread per task: " << threadLatency << " ns per task, invokeAsync: " << asyncLatency << " ns per task" << endl;
+    cout << "    All at once   - thread per task: " << threadThroughput << " ns per task, invokeAsync: " << asyncThroughput << " ns per task" << endl;
+    cout << "    Pool stats (all at once) - max depth: " << stats.maxDepth << ", average latency: " << stats.averageLatency 
+         << " ns, max latency: " << stats.maxLatency << " ns" << endl;
+
+    cout << "--- End funcHelper Async Benchmark --- " << endl;
 }
@@ -1,4 +1,11 @@
 #include "include/Examples/iniParser.hpp"
+#include <chrono>
+#include <string>
+#include <optional>
+#include <string_view>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
 
 void iniParserTest::test()
 {
@@ -62,6 +69,8 @@ void iniParserTest::test()
     cout << "Getting the var we just added: " << *file.getSection("Test")->getValue("v") << endl;
     // Assuming that the section and value exist
     cout << "This should be the same thing: " << file["Test"]["v"] << endl;
+    // the value is converted on the first read and cached for the next ones
+    cout << "Read as an int plus one: " << *file["Test"].getValue<int>("v") + 1 << endl;
 
     // creating a file if it does not already exist
     file.createFile("iniParser/CreatingFile.ini");
@@ -89,4 +98,210 @@ void iniParserTest::test()
             std::cout << keyValue.first << "=" << keyValue.second << std::endl;
         }
     }
-}
\ No newline at end of file
+
+    //* values changed through a reference after saving are still saved (including keys that where added through it)
+    std::ofstream("iniParser/references.ini", std::ios::trunc) << "[section]\nkey=value\n";
+    {
+        iniParser references("iniParser/references.ini");
+        references.setAutosave(false);
+        references.parseData();
+        std::string& added = references["section"]["added"];
+        added = "first";
+        references.save();
+        added = "second";
+        cout << "Has changes after changing a new key through its reference: " << references.isDirty() << endl;
+        references.save();
+    }
+    iniParser references("iniParser/references.ini");
+    references.parseData();
+    cout << "Saved value of the new key: " << references["section"]["added"] << endl;
+}
+
+void iniParserTest::benchmark(size_t maxMegabytes)
+{
+    using namespace std;
+
+    cout << "--- iniParser Benchmark --- " << endl;
+
+    const string path = "iniParser/benchmark.ini";
+    for (size_t megabytes: {1, 100, 1024})
+    {
+        if (megabytes > maxMegabytes)
+            break;
+
+        // sections of 1000 keys with values like the ones in generated config files
+        {
+            ofstream file(path, ios::binary | ios::trunc);
+            const size_t bytes = megabytes * 1024 * 1024;
+            size_t written = 0;
+            string text;
+            for (size_t section = 0; written < bytes; section++)
+            {
+                text = "[Section" + to_string(section) + "]\n";
+                for (size_t key = 0; key < 1000; key++)
+                    text += "key" + to_string(key) + "=" + to_string(section * 1000 + key) + " some value text, 1.5, 2.5, 3.5\n";
+                file << text;
+                written += text.size();
+            }
+        }
+
+        auto time = [&](auto&& parse){
+            iniParser parser(path);
+            parser.setAutosave(false);
+            const auto start = chrono::steady_clock::now();
+            parse(parser);
+            const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            const iniParser::SectionData* section = parser.getSection("Section0");
+            const optional<string_view> value = section ? section->getView("key999") : nullopt;
+            return make_pair(seconds, string(value.value_or("missing")));
+        };
+
+        cout << megabytes << " MB" << endl;
+        const auto copied = time([](iniParser& parser){ parser.parseData(); });
+        cout << "    parseData:   " << copied.first * 1000 << " ms (" << megabytes / copied.first << " MB/s), key999=" << copied.second << endl;
+        const auto mapped = time([](iniParser& parser){ parser.parseMapped(); });
+        cout << "    parseMapped: " << mapped.first * 1000 << " ms (" << megabytes / mapped.first << " MB/s), key999=" << mapped.second << endl;
+    }
+    filesystem::remove(path);
+
+    cout << "--- End iniParser Benchmark --- " << endl;
+}
+
+void iniParserTest::lookupBenchmark(size_t lookups)
+{
+    using namespace std;
+
+    cout << "--- iniParser Lookup Benchmark --- " << endl;
+
+    // 100 sections of 100 keys with names long enough that a std::string copy allocates
+    iniParser parser;
+    map<string, map<string, string>> baseline;
+    vector<string> sectionNames;
+    vector<string> keyNames;
+    for (size_t i = 0; i < 100; i++)
+    {
+        sectionNames.push_back("GeneratedSettingsSection" + to_string(i));
+        keyNames.push_back("generated_setting_key_name_" + to_string(i));
+    }
+    for (const string& section: sectionNames)
+        for (const string& key: keyNames)
+        {
+            parser[section][key] = key;
+            baseline[section][key] = key;
+        }
+    vector<string_view> sectionViews(sectionNames.begin(), sectionNames.end());
+    vector<string_view> keyViews(keyNames.begin(), keyNames.end());
+
+    auto time = [&](const char* name, auto&& lookup, size_t count){
+        size_t found = 0;
+        const auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++)
+            found += lookup(i % 100, (i / 100 + i) % 100);
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "    " << name << seconds * 1e9 / count << " ns per read (" << found << " found)" << endl;
+    };
+
+    // what a lookup by view cost with the old std::string keyed functions
+    time("std::map with string copy: ", [&](size_t section, size_t key){
+        auto sectionIter = baseline.find(string(sectionViews[section]));
+        return sectionIter->second.find(string(keyViews[key])) != sectionIter->second.end();
+    }, lookups);
+    time("string_view:               ", [&](size_t section, size_t key){
+        return parser.getSection(sectionViews[section])->getValue(keyViews[key]) != nullptr;
+    }, lookups);
+    time("std::string:               ", [&](size_t section, size_t key){
+        return parser.getSection(sectionNames[section])->getValue(keyNames[key]) != nullptr;
+    }, lookups);
+    time("const char*:               ", [&](size_t section, size_t key){
+        return parser.getSection(sectionNames[section].c_str())->getValue(keyNames[key].c_str()) != nullptr;
+    }, lookups);
+
+    // reading typed values with the StringHelper conversions vs the cached getValue<T>
+    iniParser::SectionData& typed = parser["Typed"];
+    typed.setValue("scale", "1.5");
+    typed.setValue("weights", "[0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5]");
+    time("toFloat:                   ", [&](size_t, size_t){
+        return StringHelper::toFloat(*typed.getValue("scale")) == 1.5f;
+    }, lookups / 10);
+    time("getValue<float>:           ", [&](size_t, size_t){
+        return *typed.getValue<float>("scale") == 1.5f;
+    }, lookups / 10);
+    time("toVector<float>:           ", [&](size_t, size_t){
+        return StringHelper::toVector<float>(*typed.getValue("weights")).size() == 8;
+    }, lookups / 10);
+    time("getValue<vector<float>>:   ", [&](size_t, size_t){
+        return typed.getValue<vector<float>>("weights")->size() == 8;
+    }, lookups / 10);
+
+    cout << "--- End iniParser Lookup Benchmark --- " << endl;
+}
+
+void iniParserTest::saveBenchmark(size_t megabytes)
+{
+    using namespace std;
+
+    cout << "--- iniParser Save Benchmark --- " << endl;
+
+    const string path = "iniParser/saveBenchmark.ini";
+    iniParser::createFile(path);
+    {
+        iniParser parser(path);
+        parser.setAutosave(false);
+        for (size_t section = 0; section * 1000 * 50 < megabytes * 1024 * 1024; section++)
+        {
+            iniParser::SectionData& data = parser["Section" + to_string(section)];
+            for (size_t key = 0; key < 1000; key++)
+                data["key" + to_string(key)] = to_string(section * 1000 + key) + " some value text, 1.5, 2.5";
+        }
+        parser.save();
+    }
+
+    iniParser parser(path);
+    parser.setAutosave(false);
+    parser.parseData();
+
+    auto time = [&](const char* name, auto&& change){
+        change();
+        const auto start = chrono::steady_clock::now();
+        parser.save();
+        cout << "    " << name << chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1000 << " ms" << endl;
+    };
+
+    cout << megabytes << " MB" << endl;
+    time("nothing changed:               ", []{});
+    time("one value, same length:        ", [&]{ parser["Section7"].setValue("key10", "7010 SOME VALUE TEXT, 1.5, 2.5"); });
+    time("1000 values, same length:      ", [&]{ 
+        for (size_t section = 0; section < 1000; section++)
+            if (auto data = parser.getSection("Section" + to_string(section)))
+            {
+                string value = *data->getValue("key500");
+                transform(value.begin(), value.end(), value.begin(), ::toupper);
+                data->setValue("key500", value);
+            }
+    });
+    time("one value, different length:   ", [&]{ parser["Section7"].setValue("key10", "a longer value than the one before"); });
+
+    // the debounced autosave only writes once for all the changes made between updates
+    parser.setAutosave(true);
+    parser.setAutosaveDelay(chrono::milliseconds(50));
+    size_t saves = 0;
+    size_t changes = 0;
+    auto writeTime = filesystem::last_write_time(path);
+    const auto start = chrono::steady_clock::now();
+    for (; chrono::steady_clock::now() - start < chrono::milliseconds(200); changes++)
+    {
+        parser["Section3"].setValue("key3", "300" + to_string(changes % 10) + " some value text, 1.5, 2.5");
+        parser.update();
+        if (filesystem::last_write_time(path) != writeTime)
+        {
+            writeTime = filesystem::last_write_time(path);
+            saves++;
+        }
+    }
+    cout << "    autosave with a 50 ms delay over 200 ms: " << changes << " changes in " << saves << " saves" << endl;
+    parser.setAutosave(false);
+    parser.closeFile();
+    filesystem::remove(path);
+
+    cout << "--- End iniParser Save Benchmark --- " << endl;
+}
@@ -1,44 +1,287 @@
 #include "Utils/EventHelper.hpp"
 
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <unordered_set>
+#include <bit>
+#include <sstream>
+
+#if __has_include("Utils/CommandHandler.hpp")
+#include "Utils/CommandHandler.hpp"
+#endif
+
 using namespace EventHelper;
 
-std::list<std::pair<Event*, std::function<void()>>> Event::Synchronized::m_events;
-std::mutex Event::Synchronized::m_lock;
+namespace
+{
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief sets the given value to the max of it and the given value
+template <typename T>
+void storeMax(std::atomic<T>& value, T newValue)
+{
+    T current = value.load(std::memory_order_relaxed);
+    while (current < newValue && !value.compare_exchange_weak(current, newValue, std::memory_order_relaxed));
+}
+
+/// @brief the anchor of the queued call this thread is invoking right now so an event can be destroyed from its own call
+thread_local const void* t_invoking = nullptr;
+
+/// @brief adds the given string to the json with quotes and anything that needs it escaped
+void writeJsonString(std::ostream& json, const std::string& str)
+{
+    json << '"';
+    for (char c: str)
+    {
+        if (c == '"' || c == '\\')
+            json << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            const char* hex = "0123456789abcdef";
+            json << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+        }
+        else
+            json << c;
+    }
+    json << '"';
+}
+
+/// @returns the name of the event or a name made from its index if it does not have one
+std::string getDisplayName(const EventStats& stats, size_t index)
+{
+    return stats.name.empty() ? "unnamed event " + std::to_string(index) : stats.name;
+}
+
+#ifdef EVENT_HELPER_STATS
+std::mutex& getStatsLock()
+{
+    static std::mutex lock;
+    return lock;
+}
+
+/// @note locked by getStatsLock
+std::unordered_set<void*>& getAllRecorders()
+{
+    static std::unordered_set<void*> recorders;
+    return recorders;
+}
+#endif
+}
+
+DispatchQueue::DispatchQueue(const std::string& name) : m_name(name) {}
 
-void Event::Synchronized::update()
+DispatchQueue::~DispatchQueue()
 {
-    m_lock.lock();
-    for (auto event: m_events)
+    Node* node = m_pending.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr)
     {
-        event.second.operator()();
+        Node* next = node->next;
+        releaseAnchor(node->anchor);
+        delete node;
+        node = next;
     }
-    m_events.clear(); // removing all the events in the queue
-    m_lock.unlock();
 }
 
-void Event::Synchronized::removeEvent(Event* event)
+DispatchQueue& DispatchQueue::get(const std::string& name)
 {
-    m_lock.lock();
-    // removing from list
-    m_events.remove_if(
-        [event](const std::pair<EventHelper::Event *, std::function<void()>>& v){
-            return v.first == event;
-        });
-    m_lock.unlock();
+    static std::mutex lock;
+    static std::map<std::string, std::unique_ptr<DispatchQueue>> queues;
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<DispatchQueue>& queue = queues[name];
+    if (queue == nullptr)
+        queue = std::make_unique<DispatchQueue>(name);
+    return *queue;
 }
 
-std::deque<const void*> Event::m_parameters(5, nullptr);
+void DispatchQueue::update()
+{
+    if (m_updating)
+        return;
+
+    #ifndef NDEBUG
+    std::thread::id owner;
+    m_owner.compare_exchange_strong(owner, std::this_thread::get_id());
+    assert((owner == std::thread::id() || owner == std::this_thread::get_id()) && "A DispatchQueue should only be updated by one thread");
+    #endif
+
+    Node* batch = nullptr;
+    // taking every event added so far, anything added while calling them will be in the next update
+    Node* node = m_pending.exchange(nullptr, std::memory_order_acquire);
+    // reversing so events are called in the order they were added
+    while (node != nullptr)
+    {
+        Node* next = node->next;
+        node->next = batch;
+        batch = node;
+        node = next;
+    }
+
+    // makes sure the batch is freed even if a callback throws
+    struct BatchGuard
+    {
+        ~BatchGuard()
+        {
+            queue.m_updating = false;
+            size_t count = 0;
+            while (batch != nullptr)
+            {
+                Node* next = batch->next;
+                releaseAnchor(batch->anchor);
+                delete batch;
+                batch = next;
+                ++count;
+            }
+            queue.m_depth.fetch_sub(count, std::memory_order_relaxed);
+            queue.m_called.fetch_add(called, std::memory_order_relaxed);
+            queue.m_skipped.fetch_add(count - called, std::memory_order_relaxed);
+            queue.m_totalLatency.fetch_add(totalLatency, std::memory_order_relaxed);
+            storeMax(queue.m_maxLatency, maxLatency);
+        }
+        DispatchQueue& queue;
+        Node* batch;
+        size_t called = 0;
+        uint64_t totalLatency = 0;
+        uint64_t maxLatency = 0;
+    } guard{*this, batch};
+    m_updating = true;
+
+    // keeps the call counted as in flight until it returns (or throws)
+    struct InFlightGuard
+    {
+        InFlightGuard(Anchor* anchor) : anchor(anchor), previous(t_invoking)
+        {
+            anchor->inFlight.fetch_add(1);
+            t_invoking = anchor;
+        }
+        ~InFlightGuard()
+        {
+            t_invoking = previous;
+            anchor->inFlight.fetch_sub(1, std::memory_order_release);
+        }
+        Anchor* anchor;
+        const void* previous;
+    };
+
+    for (node = batch; node != nullptr; node = node->next)
+    {
+        Anchor* anchor = node->anchor;
+        // marking the call as in flight before checking the event so the event can not be destroyed while it is being called
+        InFlightGuard inFlight{anchor};
+        // skipping calls of destroyed events and calls that where removed after being queued
+        if (anchor->event.load() == nullptr || 
+            node->generation != anchor->generation.load(std::memory_order_acquire))
+            continue;
+
+        const uint64_t latency = now() - node->queuedTime;
+        guard.totalLatency += latency;
+        guard.maxLatency = std::max(guard.maxLatency, latency);
+        ++guard.called;
+        #ifdef EVENT_HELPER_STATS
+        anchor->event.load(std::memory_order_relaxed)->m_stats->recordQueueWait(latency);
+        #endif
+        node->func();
+    }
+}
+
+void DispatchQueue::removeEvent(Event* event)
+{
+    if (Anchor* anchor = event->m_anchor.load(std::memory_order_acquire))
+        anchor->generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void DispatchQueue::addEvent(Event* event, funcHelper::inplaceFunc<void()>&& func, bool removeSameEvents)
+{
+    Anchor* anchor = getAnchor(event);
+    anchor->references.fetch_add(1, std::memory_order_relaxed);
+    // moving to a new generation removes every call that was queued before this one
+    const size_t generation = removeSameEvents ? anchor->generation.fetch_add(1, std::memory_order_acq_rel) + 1 
+                                               : anchor->generation.load(std::memory_order_acquire);
+
+    Node* node = new Node{anchor, generation, now(), std::move(func)};
+    node->next = m_pending.load(std::memory_order_relaxed);
+    while (!m_pending.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+
+    m_queued.fetch_add(1, std::memory_order_relaxed);
+    storeMax(m_maxDepth, m_depth.fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+DispatchQueue::Stats DispatchQueue::getStats() const
+{
+    Stats stats;
+    stats.depth = m_depth.load(std::memory_order_relaxed);
+    stats.maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+    stats.queued = m_queued.load(std::memory_order_relaxed);
+    stats.called = m_called.load(std::memory_order_relaxed);
+    stats.skipped = m_skipped.load(std::memory_order_relaxed);
+    stats.averageLatency = stats.called == 0 ? 0 : double(m_totalLatency.load(std::memory_order_relaxed)) / stats.called;
+    stats.maxLatency = m_maxLatency.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void DispatchQueue::resetStats()
+{
+    // the depth is the current state of the queue so it is kept
+    m_maxDepth = m_depth.load(std::memory_order_relaxed);
+    m_queued = 0;
+    m_called = 0;
+    m_skipped = 0;
+    m_totalLatency = 0;
+    m_maxLatency = 0;
+}
+
+DispatchQueue::Anchor* DispatchQueue::getAnchor(Event* event)
+{
+    Anchor* anchor = event->m_anchor.load(std::memory_order_acquire);
+    if (anchor != nullptr)
+        return anchor;
+
+    // the event could be queued from multiple threads at once so only the first anchor is kept
+    Anchor* created = new Anchor(event);
+    if (event->m_anchor.compare_exchange_strong(anchor, created, std::memory_order_acq_rel, std::memory_order_acquire))
+        return created;
+    delete created;
+    return anchor;
+}
+
+void DispatchQueue::releaseAnchor(Anchor* anchor)
+{
+    if (anchor->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete anchor;
+}
+
+void DispatchQueue::detachEvent(Event* event)
+{
+    Anchor* anchor = event->m_anchor.load(std::memory_order_acquire);
+    if (anchor == nullptr)
+        return;
+
+    anchor->event.store(nullptr);
+    // waiting for calls that already passed the check in update, if this event is destroyed from one of its own queued calls that call is not waited on
+    const size_t own = t_invoking == anchor ? 1 : 0;
+    while (anchor->inFlight.load() > own)
+        std::this_thread::yield();
+    releaseAnchor(anchor);
+}
+
+DispatchQueue& Event::Synchronized::getQueue()
+{
+    static DispatchQueue& queue = DispatchQueue::get("Synchronized");
+    return queue;
+}
 
 bool Event::disconnect(size_t id)
 {
-    return (m_callbacks.erase(id) != 0);
+    return m_callbacks.erase(id);
 }
 
 void Event::disconnectAll()
 {
-    // all public ids will be greater than m_nextPublicID
-    auto iter = m_callbacks.lower_bound(m_nextPublicID);
-    m_callbacks.erase(iter, m_callbacks.end());
+    m_callbacks.clearPublic();
     
     // Reset the public ID counter
     m_nextPublicID = STARTING_PUBLIC_ID;
@@ -51,23 +294,311 @@ void Event::invoke(bool threadSafe, bool removeOtherInstances)
 
     if (threadSafe)
     {
-        Event::Synchronized::addEvent(this, [this]{ Event::invokeFunc(&Event::_invoke, this); }, removeOtherInstances);
+        invoke(Event::Synchronized::getQueue(), removeOtherInstances);
+        return;
     }
 
     _invoke();
 }
 
-void Event::_invoke()
+void Event::invoke(DispatchQueue& queue, bool removeOtherInstances)
 {
-    auto callback = m_callbacks.begin();
-    while (callback != m_callbacks.end())
-    {
-        auto temp = callback++;
-        (*temp).second();
-    }
+    if (m_callbacks.empty() || !m_enabled)
+        return;
+
+    queue.addEvent(this, [this]{ this->_invoke(); }, removeOtherInstances);
+}
+
+void Event::_invoke(const void* params)
+{
+    #ifdef EVENT_HELPER_STATS
+    // the end of each callback is the start of the next so the clock is only read once per callback
+    const uint64_t start = now();
+    uint64_t last = start;
+    m_callbacks.forEach([params, &last](Callback& callback){
+        callback.func(params);
+        const uint64_t end = now();
+        callback.counters->record(end - last);
+        last = end;
+    });
+    m_stats->recordInvoke(last - start, m_callbacks.size());
+    #else
+    m_callbacks.forEach([params](Callback& callback){ callback(params); });
+    #endif
+}
+
+void Event::invokeParallel(size_t grainSize, ThreadPool& pool)
+{
+    if (m_callbacks.empty() || !m_enabled)
+        return;
+
+    _invokeParallel(grainSize, pool);
+}
+
+void Event::_invokeParallel(size_t grainSize, ThreadPool& pool, const void* params)
+{
+    #ifdef EVENT_HELPER_STATS
+    const uint64_t start = now();
+    #endif
+    m_callbacks.forEachParallel(pool, grainSize, [params](Callback& callback){ callback(params); });
+    #ifdef EVENT_HELPER_STATS
+    m_stats->recordInvoke(now() - start, m_callbacks.size());
+    #endif
 }
 
 size_t Event::getNumCallbacks() const
 {
     return m_callbacks.size();
 }
+
+// * Stats
+
+void Event::setStatsName(const std::string& name)
+{
+    #ifdef EVENT_HELPER_STATS
+    std::lock_guard<std::mutex> guard(m_stats->lock);
+    m_stats->name = name;
+    #else
+    (void)name;
+    #endif
+}
+
+EventStats Event::getStats() const
+{
+    #ifdef EVENT_HELPER_STATS
+    return m_stats->get();
+    #else
+    return {};
+    #endif
+}
+
+void Event::resetStats()
+{
+    #ifdef EVENT_HELPER_STATS
+    m_stats->reset();
+    #endif
+}
+
+std::vector<EventStats> Event::getAllStats()
+{
+    std::vector<EventStats> stats;
+    #ifdef EVENT_HELPER_STATS
+    {
+        std::lock_guard<std::mutex> guard(getStatsLock());
+        stats.reserve(getAllRecorders().size());
+        for (void* recorder: getAllRecorders())
+            stats.emplace_back(static_cast<const StatsRecorder*>(recorder)->get());
+    }
+    std::stable_sort(stats.begin(), stats.end(), [](const EventStats& a, const EventStats& b){ return a.totalTime > b.totalTime; });
+    #endif
+    return stats;
+}
+
+void Event::resetAllStats()
+{
+    #ifdef EVENT_HELPER_STATS
+    std::lock_guard<std::mutex> guard(getStatsLock());
+    for (void* recorder: getAllRecorders())
+        static_cast<StatsRecorder*>(recorder)->reset();
+    #endif
+}
+
+std::string Event::dumpStats(size_t maxEvents)
+{
+    const std::vector<EventStats> stats = getAllStats();
+
+    std::stringstream json;
+    #ifdef EVENT_HELPER_STATS
+    json << "{\"enabled\":true,\"histogramBuckets\":[";
+    #else
+    json << "{\"enabled\":false,\"histogramBuckets\":[";
+    #endif
+    for (size_t i = 0; i < STATS_HISTOGRAM_BUCKETS; i++)
+        json << (i == 0 ? "" : ",") << (uint64_t(1) << (i + 7));
+    json << "],\"events\":[";
+    for (size_t i = 0; i < std::min(maxEvents, stats.size()); i++)
+    {
+        const EventStats& event = stats[i];
+        json << (i == 0 ? "" : ",") << "{\"name\":";
+        writeJsonString(json, getDisplayName(event, i));
+        json << ",\"invokes\":" << event.invokes << ",\"subscribers\":" << event.subscribers 
+             << ",\"totalTime\":" << event.totalTime << ",\"maxTime\":" << event.maxTime 
+             << ",\"queuedCalls\":" << event.queuedCalls << ",\"totalQueueWait\":" << event.totalQueueWait 
+             << ",\"maxQueueWait\":" << event.maxQueueWait << ",\"callbacks\":[";
+        for (size_t c = 0; c < event.callbacks.size(); c++)
+        {
+            const CallbackStats& callback = event.callbacks[c];
+            json << (c == 0 ? "" : ",") << "{\"id\":" << callback.id << ",\"calls\":" << callback.calls 
+                 << ",\"totalTime\":" << callback.totalTime << ",\"maxTime\":" << callback.maxTime << ",\"histogram\":[";
+            for (size_t b = 0; b < STATS_HISTOGRAM_BUCKETS; b++)
+                json << (b == 0 ? "" : ",") << callback.histogram[b];
+            json << "]}";
+        }
+        json << "]}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+void Event::initCommand()
+{
+    #ifdef COMMAND_HANDLER_H
+    Command::Handler::get().addCommand("events", "Contains commands for event stats", {Command::helpPrint, "events"});
+    Command::Handler::get().findCommand("events")
+    ->addCommand("stats", "[count = 10] | Shows the events that spent the most time in there callbacks", {[](Command::Data* data){
+            #ifdef EVENT_HELPER_STATS
+            unsigned long count = 10;
+            if (data->getNumTokens() > 0 && !Command::isValidInput<unsigned long>(data->getToken(0), count, 10))
+                data->addWarning(Command::WARNING_COLOR + "Warning" + Command::END_COLOR + " - Invalid count, showing 10 events");
+
+            const std::vector<EventStats> stats = Event::getAllStats();
+            std::stringstream str;
+            str << stats.size() << " events (times in us)";
+            for (size_t i = 0; i < std::min<size_t>(count, stats.size()); i++)
+            {
+                const EventStats& event = stats[i];
+                str << "\n" << getDisplayName(event, i) << " - invokes: " << event.invokes << ", subscribers: " << event.subscribers
+                    << ", total: " << event.totalTime / 1000.0 << ", avg: " << (event.invokes == 0 ? 0 : event.totalTime / 1000.0 / event.invokes)
+                    << ", max: " << event.maxTime / 1000.0;
+                if (event.queuedCalls > 0)
+                    str << ", queue wait avg: " << event.totalQueueWait / 1000.0 / event.queuedCalls << ", max: " << event.maxQueueWait / 1000.0;
+                for (const CallbackStats& callback: event.callbacks)
+                {
+                    str << "\n" TAB_STR "callback " << callback.id << " - calls: " << callback.calls << ", total: " << callback.totalTime / 1000.0
+                        << ", max: " << callback.maxTime / 1000.0;
+                }
+            }
+            data->setReturnStr(str.str());
+            #else
+            data->setReturnStr("Event stats are disabled, define EVENT_HELPER_STATS to record them");
+            #endif
+        }})
+    .addCommand("dump", "[count = all] | Returns the stats of the events as json", {[](Command::Data* data){
+            unsigned long count = SIZE_MAX;
+            if (data->getNumTokens() > 0 && !Command::isValidInput<unsigned long>(data->getToken(0), count, SIZE_MAX))
+                data->addWarning(Command::WARNING_COLOR + "Warning" + Command::END_COLOR + " - Invalid count, dumping every event");
+            data->setReturnStr(Event::dumpStats(count));
+        }})
+    .addCommand("reset", "Resets the stats of every event", {[](Command::Data* data){
+            Event::resetAllStats();
+            data->setReturnStr("Event stats reset");
+        }});
+    #endif
+}
+
+#ifdef EVENT_HELPER_STATS
+void Event::Callback::operator()(const void* params) const
+{
+    const uint64_t start = now();
+    func(params);
+    counters->record(now() - start);
+}
+
+void Event::CallbackCounters::record(uint64_t time)
+{
+    calls.fetch_add(1, std::memory_order_relaxed);
+    totalTime.fetch_add(time, std::memory_order_relaxed);
+    storeMax(maxTime, time);
+    histogram[std::min<size_t>(std::bit_width(time >> 7), STATS_HISTOGRAM_BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+
+CallbackStats Event::CallbackCounters::get() const
+{
+    CallbackStats stats;
+    stats.id = id;
+    stats.calls = calls.load(std::memory_order_relaxed);
+    stats.totalTime = totalTime.load(std::memory_order_relaxed);
+    stats.maxTime = maxTime.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < STATS_HISTOGRAM_BUCKETS; i++)
+        stats.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Event::CallbackCounters::reset()
+{
+    calls = 0;
+    totalTime = 0;
+    maxTime = 0;
+    for (std::atomic<uint64_t>& bucket: histogram)
+        bucket = 0;
+}
+
+void Event::StatsRecorder::recordInvoke(uint64_t time, size_t subscribers)
+{
+    invokes.fetch_add(1, std::memory_order_relaxed);
+    this->subscribers.store(subscribers, std::memory_order_relaxed);
+    totalTime.fetch_add(time, std::memory_order_relaxed);
+    storeMax(maxTime, time);
+}
+
+void Event::StatsRecorder::recordQueueWait(uint64_t time)
+{
+    queuedCalls.fetch_add(1, std::memory_order_relaxed);
+    totalQueueWait.fetch_add(time, std::memory_order_relaxed);
+    storeMax(maxQueueWait, time);
+}
+
+std::shared_ptr<Event::CallbackCounters> Event::StatsRecorder::addCallback(size_t id)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    // removing disconnected callbacks whenever the list doubles so this stays amortized O(1)
+    if (callbacks.size() >= pruneSize)
+    {
+        std::erase_if(callbacks, [](const std::shared_ptr<CallbackCounters>& counters){ return counters.use_count() == 1; });
+        pruneSize = std::max<size_t>(16, callbacks.size() * 2);
+    }
+    return callbacks.emplace_back(std::make_shared<CallbackCounters>(id));
+}
+
+EventStats Event::StatsRecorder::get() const
+{
+    EventStats stats;
+    stats.invokes = invokes.load(std::memory_order_relaxed);
+    stats.subscribers = subscribers.load(std::memory_order_relaxed);
+    stats.totalTime = totalTime.load(std::memory_order_relaxed);
+    stats.maxTime = maxTime.load(std::memory_order_relaxed);
+    stats.queuedCalls = queuedCalls.load(std::memory_order_relaxed);
+    stats.totalQueueWait = totalQueueWait.load(std::memory_order_relaxed);
+    stats.maxQueueWait = maxQueueWait.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> guard(lock);
+    stats.name = name;
+    for (const std::shared_ptr<CallbackCounters>& counters: callbacks)
+    {
+        if (counters.use_count() > 1)
+            stats.callbacks.emplace_back(counters->get());
+    }
+    return stats;
+}
+
+void Event::StatsRecorder::reset()
+{
+    invokes = 0;
+    totalTime = 0;
+    maxTime = 0;
+    queuedCalls = 0;
+    totalQueueWait = 0;
+    maxQueueWait = 0;
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (const std::shared_ptr<CallbackCounters>& counters: callbacks)
+        counters->reset();
+}
+
+Event::StatsRecorder* Event::registerStats()
+{
+    StatsRecorder* stats = new StatsRecorder();
+    std::lock_guard<std::mutex> guard(getStatsLock());
+    getAllRecorders().insert(stats);
+    return stats;
+}
+
+void Event::unregisterStats(StatsRecorder* stats)
+{
+    {
+        std::lock_guard<std::mutex> guard(getStatsLock());
+        getAllRecorders().erase(stats);
+    }
+    delete stats;
+}
+#endif
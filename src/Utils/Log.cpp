@@ -4,40 +4,855 @@
 #include <ctime>
 #include <iostream>
 #include <cassert>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <bit>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <deque>
+#include <system_error>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+/// @brief total number of logs dropped by the async writers
+std::atomic<size_t> droppedCount = 0;
+/// @brief used to tell if a threads staging buffer belongs to the current async writer
+std::atomic<uint64_t> writerGeneration = 0;
+/// @brief held while writing to the file (and opening it) so lines from different threads are never mixed
+std::mutex fileLock;
+
+/// @brief the type and format string of every registered binary format, the id is the index + 1
+std::vector<std::pair<Log::Type, std::string>> formats;
+std::mutex formatLock;
+
+/// @brief the start of every binary log file
+constexpr char binaryMagic[8] = {'C', 'U', 'B', 'L', 'O', 'G', '1', '\n'};
+/// @brief followed by the id (uint32), type (int8), format size (uint32), and format
+constexpr char formatTag = 1;
+/// @brief followed by the id (uint32), time in ns since the epoch (int64), arguments size (uint32), and arguments
+constexpr char logTag = 2;
+
+/// @brief the state of the log files, only used while holding the file lock
+struct Segments
+{
+    /// @brief 0 for no limit
+    uintmax_t maxFileSize = 0;
+    /// @brief 0 for no limit
+    uintmax_t maxFolderSize = 0;
+
+    /// @brief true once the log folder was scanned for old logs
+    bool scanned = false;
+    /// @brief true if the scan found the old logs, otherwise only the files started by this run are known
+    bool sized = false;
+    std::string date;
+    /// @brief the index of the current file for the date, 0 is "date.log" and i is "date-(i-1).log"
+    size_t index = 0;
+
+    /// @brief the bytes written to the current files
+    uintmax_t textSize = 0;
+    uintmax_t binarySize = 0;
+    /// @brief the bytes preallocated for the current files
+    uintmax_t textPreallocated = 0;
+    uintmax_t binaryPreallocated = 0;
+
+    /// @brief every log file in the folder other than the current ones, oldest first
+    std::deque<std::pair<std::string, uintmax_t>> oldFiles;
+    /// @brief the total size of the old files
+    uintmax_t oldFilesSize = 0;
+} segments;
+
+std::string segmentPath(const std::string& folder, const std::string& date, size_t index, const char* extension)
+{
+    return folder + "/" + date + (index == 0 ? "" : "-" + std::to_string(index - 1)) + extension;
+}
+
+/// @brief the old logs of a folder and there sizes are saved in this file when the program exits so the next launch does not have to look at every file
+constexpr const char* indexFileName = "Logs.index";
+/// @brief the first line of the index file
+constexpr const char* indexHeader = "LOGINDEX1";
+
+/// @brief reads the old logs (oldest first) saved in the index file of the folder
+/// @returns false if there is no index or files where added to or removed from the folder after it was saved
+bool loadIndex(const std::filesystem::path& folder, std::vector<std::pair<std::string, uintmax_t>>& files)
+{
+    std::error_code error;
+    const std::filesystem::file_time_type indexTime = std::filesystem::last_write_time(folder / indexFileName, error);
+    if (error)
+        return false;
+    // adding or removing a file changes the folders time, equal times could be from the same clock tick so they are not trusted
+    const std::filesystem::file_time_type folderTime = std::filesystem::last_write_time(folder, error);
+    if (error || folderTime >= indexTime)
+        return false;
+
+    std::ifstream file(folder / indexFileName);
+    std::string line;
+    if (!std::getline(file, line) || line != indexHeader)
+        return false;
+    // each line is the size then the file name
+    uintmax_t size;
+    while (file >> size && file.get() == ' ' && std::getline(file, line))
+        files.emplace_back((folder / line).string(), size);
+    return file.eof();
+}
+
+/// @brief reserves the given number of bytes on disk for the file without changing its size so writes do not have to grow it
+/// @returns the number of bytes that where preallocated (0 if not supported)
+uintmax_t preallocate(const std::string& path, uintmax_t size)
+{
+    #ifdef __linux__
+    if (size == 0)
+        return 0;
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return 0;
+    const bool allocated = ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)size) == 0;
+    ::close(fd);
+    return allocated ? size : 0;
+    #else
+    return 0;
+    #endif
+}
+
+/// @brief gives back the preallocated space after the end of the file
+void releasePreallocation(const std::string& path, uintmax_t preallocated)
+{
+    #ifdef __linux__
+    if (preallocated == 0)
+        return;
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    // truncating to the same size frees the blocks after the end (punching a hole does not on every file system)
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && (uintmax_t)info.st_size < preallocated)
+        (void)::ftruncate(fd, info.st_size);
+    ::close(fd);
+    #endif
+}
+
+template <typename T>
+void appendBytes(std::string& data, T value)
+{
+    data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readBytes(std::istream& input, T& value)
+{
+    return (bool)input.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+/// @brief the monotonic clock time the program started at
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+/// @brief the wall clock time minus the monotonic time in ns
+std::atomic<int64_t> wallOffset = 0;
+/// @brief the monotonic time (since the start) in ns when the wall offset should be updated next
+std::atomic<int64_t> nextWallSync = INT64_MIN;
+
+/// @brief the text of the last second formatted by this thread, the micro seconds go between the prefix and suffix
+struct TimeCache
+{
+    int64_t second = INT64_MIN;
+    /// @brief "Www Mmm dd hh:mm:ss"
+    char prefix[32];
+    size_t prefixSize = 0;
+    /// @brief " yyyy"
+    char suffix[16];
+    size_t suffixSize = 0;
+};
+thread_local TimeCache timeCache;
+
+/// @brief appends the number with at least the given number of digits (padded with 0s)
+void appendDigits(std::string& line, uint64_t value, int digits)
+{
+    char buffer[20];
+    int size = 0;
+    do
+    {
+        buffer[sizeof(buffer) - ++size] = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0 || size < digits);
+    line.append(buffer + sizeof(buffer) - size, size);
+}
+
+/// @brief the flight recorder file is a header followed by fixed size slots, each line takes one or more slots in a row
+/// @note header: magic (8 bytes), slot size (uint32), slot count (uint32), next sequence (uint64), clean exit (uint8)
+constexpr char ringMagic[8] = {'C', 'U', 'B', 'R', 'I', 'N', 'G', '1'};
+constexpr size_t ringHeaderSize = 64;
+constexpr size_t ringSlotSizeOffset = 8;
+constexpr size_t ringSlotCountOffset = 12;
+constexpr size_t ringNextOffset = 16;
+constexpr size_t ringCleanOffset = 24;
+/// @note slot: sequence (uint64, 0 while being written), size (uint16), flags (uint8), data
+/// @note the data of a log is: wall time in ns since the epoch (int64), monotonic time in ns (int64), type (int8), message
+constexpr uint32_t ringSlotSize = 128;
+constexpr size_t ringSlotSizeFieldOffset = 8;
+constexpr size_t ringSlotFlagsOffset = 10;
+constexpr size_t ringSlotDataOffset = 11;
+constexpr size_t ringSlotDataSize = ringSlotSize - ringSlotDataOffset;
+constexpr uint8_t ringFirstSlot = 1;
+constexpr uint8_t ringLastSlot = 2;
+
+std::tm toLocalTime(std::time_t time)
+{
+    std::tm result;
+    #ifdef _WIN32
+    localtime_s(&result, &time);
+    #else
+    localtime_r(&time, &result);
+    #endif
+    return result;
+}
+}
+
+/// @brief every thread that logs gets its own lock free staging buffer which a background thread merges (in timestamp order) and writes to the file in batches
+/// @note threads never wait on each other when logging, adding a log only touches a lock if the writer is sleeping
+class Log::AsyncWriter
+{
+public:
+    AsyncWriter(size_t bufferSize, OverflowPolicy policy);
+    /// @note writes everything still in the buffers
+    ~AsyncWriter();
+
+    /// @param format 0 for text logs, otherwise the message is the encoded arguments of a binary log
+    void push(Log::Type logType, std::string&& message, Log::FormatID format = 0);
+    /// @brief waits until every log pushed before this call is written
+    void flush();
+
+private:
+    struct Record
+    {
+        Log::Type type;
+        Log::Timestamp time;
+        /// @brief the encoded arguments for binary logs
+        std::string message;
+        /// @brief 0 for text logs
+        Log::FormatID format;
+    };
+
+    /// @brief single producer single consumer ring buffer owned by one thread
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(size_t size) : records(std::make_unique<Record[]>(size)), mask(size - 1) {}
+
+        std::unique_ptr<Record[]> records;
+        const size_t mask;
+        // kept on different cache lines so the owning thread and the writer dont fight over them
+        /// @brief only written by the owning thread
+        alignas(64) std::atomic<size_t> pushed = 0;
+        /// @brief only written by the writer
+        alignas(64) std::atomic<size_t> popped = 0;
+        /// @brief every record before this has been written to the file
+        std::atomic<size_t> written = 0;
+        /// @brief set when the owning thread exits, the buffer is removed once it is empty
+        std::atomic<bool> closed = false;
+    };
+
+    /// @brief the staging buffer of this thread, replaced when a new writer is started
+    struct LocalBuffer
+    {
+        std::shared_ptr<ThreadBuffer> buffer;
+        uint64_t generation = 0;
+
+        ~LocalBuffer()
+        {
+            if (buffer != nullptr)
+                buffer->closed.store(true, std::memory_order_release);
+        }
+    };
+
+    ThreadBuffer& getLocalBuffer();
+    void wake();
+    void run();
+    /// @brief moves everything in the buffers into the batch and removes buffers of threads that exited
+    void collect(std::vector<Record>& batch, std::vector<std::pair<ThreadBuffer*, size_t>>& collected);
+    /// @brief writes and clears the encoded logs, the file lock must be held
+    void writeEncoded(std::string& lines, std::string& binary);
+
+    static thread_local LocalBuffer m_localBuffer;
+
+    const size_t m_bufferSize;
+    const OverflowPolicy m_policy;
+    const uint64_t m_generation;
+
+    /// @brief drops that have not had a warning written yet
+    std::atomic<size_t> m_unreportedDrops = 0;
+    std::atomic<bool> m_sleeping = false;
+
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    bool m_stopping = false;
+    /// @brief every buffer that can still have records, only changed while holding the lock
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    std::thread m_thread;
+};
+
+thread_local Log::AsyncWriter::LocalBuffer Log::AsyncWriter::m_localBuffer;
+
+Log::AsyncWriter::AsyncWriter(size_t bufferSize, OverflowPolicy policy) :
+    m_bufferSize(std::bit_ceil(std::max<size_t>(bufferSize, 2))), m_policy(policy), m_generation(++writerGeneration)
+{
+    m_thread = std::thread(&AsyncWriter::run, this);
+}
+
+Log::AsyncWriter::~AsyncWriter()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+Log::AsyncWriter::ThreadBuffer& Log::AsyncWriter::getLocalBuffer()
+{
+    if (m_localBuffer.generation != m_generation)
+    {
+        if (m_localBuffer.buffer != nullptr)
+            m_localBuffer.buffer->closed.store(true, std::memory_order_release);
+        m_localBuffer.buffer = std::make_shared<ThreadBuffer>(m_bufferSize);
+        m_localBuffer.generation = m_generation;
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_buffers.emplace_back(m_localBuffer.buffer);
+    }
+    return *m_localBuffer.buffer;
+}
+
+void Log::AsyncWriter::push(Log::Type logType, std::string&& message, Log::FormatID format)
+{
+    ThreadBuffer& buffer = this->getLocalBuffer();
+    const size_t pos = buffer.pushed.load(std::memory_order_relaxed);
+    while (pos - buffer.popped.load(std::memory_order_acquire) > buffer.mask)
+    {
+        if (m_policy == OverflowPolicy::Block)
+        {
+            this->wake();
+            std::this_thread::yield();
+            continue;
+        }
+
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        if (m_policy == OverflowPolicy::DropAndCount)
+            m_unreportedDrops.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.records[pos & buffer.mask] = {logType, Log::now(), std::move(message), format};
+    buffer.pushed.store(pos + 1, std::memory_order_release);
+
+    // pairs with the fence in "run" so either the writer sees this record or this sees that the writer is sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed))
+        this->wake();
+}
+
+void Log::AsyncWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    std::vector<std::pair<std::shared_ptr<ThreadBuffer>, size_t>> targets;
+    targets.reserve(m_buffers.size());
+    for (const std::shared_ptr<ThreadBuffer>& buffer: m_buffers)
+        targets.emplace_back(buffer, buffer->pushed.load(std::memory_order_acquire));
+    m_wake.notify_one();
+    m_flushed.wait(lock, [&targets]{
+        return std::all_of(targets.begin(), targets.end(), [](const auto& target){ 
+            return target.first->written.load(std::memory_order_acquire) >= target.second; 
+        });
+    });
+}
+
+void Log::AsyncWriter::wake()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+    }
+    m_wake.notify_one();
+}
+
+void Log::AsyncWriter::writeEncoded(std::string& lines, std::string& binary)
+{
+    if (!lines.empty())
+        Log::write(lines);
+    if (!binary.empty())
+        Log::writeBinary(binary);
+    lines.clear();
+    binary.clear();
+}
+
+void Log::AsyncWriter::collect(std::vector<Record>& batch, std::vector<std::pair<ThreadBuffer*, size_t>>& collected)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (size_t i = 0; i < m_buffers.size();)
+    {
+        ThreadBuffer& buffer = *m_buffers[i];
+        // checking closed first so a record pushed right before closing is not missed
+        const bool closed = buffer.closed.load(std::memory_order_acquire);
+        const size_t pushed = buffer.pushed.load(std::memory_order_acquire);
+        size_t pos = buffer.popped.load(std::memory_order_relaxed);
+        if (pos == pushed && closed && buffer.written.load(std::memory_order_relaxed) == pushed)
+        {
+            m_buffers[i] = std::move(m_buffers.back());
+            m_buffers.pop_back();
+            continue;
+        }
+
+        for (; pos != pushed; pos++)
+            batch.emplace_back(std::move(buffer.records[pos & buffer.mask]));
+        buffer.popped.store(pos, std::memory_order_release);
+        collected.emplace_back(&buffer, pos);
+        i++;
+    }
+}
+
+void Log::AsyncWriter::run()
+{
+    std::string lines;
+    std::string binary;
+    std::vector<Record> batch;
+    std::vector<std::pair<ThreadBuffer*, size_t>> collected;
+    while (true)
+    {
+        this->collect(batch, collected);
+        // every buffer is already in order so this only interleaves them
+        std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b){ return a.time.monotonic < b.time.monotonic; });
+        {
+            // holding the lock while encoding since binary logs need to know which formats the file has
+            std::lock_guard<std::mutex> guard(fileLock);
+            Log::prepareFile();
+            for (const Record& record: batch)
+            {
+                // writing what was encoded for the current file before a new one is started
+                if (segments.maxFileSize != 0 && segments.textSize + segments.binarySize + lines.size() + binary.size() >= segments.maxFileSize)
+                {
+                    this->writeEncoded(lines, binary);
+                    Log::prepareFile();
+                }
+                if (record.format == 0)
+                    Log::formatLine(lines, record.type, record.time, record.message);
+                else
+                    Log::appendBinary(binary, record.format, record.time.wall, record.message);
+            }
+            if (const size_t dropped = m_unreportedDrops.exchange(0, std::memory_order_relaxed))
+                Log::formatLine(lines, Log::Type::Warning, Log::now(), std::to_string(dropped) + " logs where dropped because the async log buffers where full");
+
+            this->writeEncoded(lines, binary);
+        }
+        const bool wroteRecords = !batch.empty();
+        batch.clear();
+        {
+            // buffers are only removed by this thread so the pointers are still valid
+            std::lock_guard<std::mutex> guard(m_lock);
+            for (const auto& [buffer, pos]: collected)
+                buffer->written.store(pos, std::memory_order_release);
+        }
+        collected.clear();
+        m_flushed.notify_all();
+        if (wroteRecords)
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const bool hasRecords = std::any_of(m_buffers.begin(), m_buffers.end(), [](const std::shared_ptr<ThreadBuffer>& buffer){
+            return buffer->pushed.load(std::memory_order_relaxed) != buffer->popped.load(std::memory_order_relaxed) || buffer->closed.load(std::memory_order_relaxed);
+        });
+        if (!hasRecords && m_unreportedDrops.load(std::memory_order_relaxed) == 0)
+        {
+            if (m_stopping)
+                return;
+            // waking up every so often anyways incase a wake was missed
+            m_wake.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+/// @brief a memory mapped ring file that logs are copied into, the os writes the pages to the file even if the program crashes
+class Log::FlightRecorder
+{
+public:
+    FlightRecorder(const std::string& path, size_t size);
+    /// @note marks the ring as cleanly closed
+    ~FlightRecorder();
+
+    inline bool isOpen() const { return m_data != nullptr; }
+    /// @brief copies the log into the ring without formatting it, it is formatted when recovered
+    /// @note can be called from any thread
+    void write(Log::Type logType, const Log::Timestamp& time, const std::string& message);
+
+private:
+    char* m_data = nullptr;
+    size_t m_size = 0;
+    uint64_t m_slotCount = 0;
+    #ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    #endif
+};
+
+Log::FlightRecorder::FlightRecorder(const std::string& path, size_t size)
+{
+    m_slotCount = std::max<size_t>(size > ringHeaderSize ? (size - ringHeaderSize) / ringSlotSize : 0, 2);
+    m_size = ringHeaderSize + m_slotCount * ringSlotSize;
+
+    #ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return;
+    // mapping more than the file size makes the file that big
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)m_size >> 32), (DWORD)m_size, nullptr);
+    if (m_mapping == nullptr)
+        return;
+    m_data = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_size));
+    #else
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+    if (::ftruncate(fd, (off_t)m_size) == 0)
+    {
+        void* data = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        m_data = data == MAP_FAILED ? nullptr : static_cast<char*>(data);
+    }
+    // the mapping keeps the file open
+    ::close(fd);
+    #endif
+    if (m_data == nullptr)
+        return;
+
+    // touching every page now so the first writes to each slot do not fault
+    std::memset(m_data, 0, m_size);
+    std::memcpy(m_data, ringMagic, sizeof(ringMagic));
+    const uint32_t slotSize = ringSlotSize;
+    const uint32_t slotCount = (uint32_t)m_slotCount;
+    std::memcpy(m_data + ringSlotSizeOffset, &slotSize, sizeof(slotSize));
+    std::memcpy(m_data + ringSlotCountOffset, &slotCount, sizeof(slotCount));
+    // sequences start at 1 since 0 marks an empty slot
+    std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(m_data + ringNextOffset)).store(1, std::memory_order_relaxed);
+}
+
+Log::FlightRecorder::~FlightRecorder()
+{
+    if (m_data != nullptr)
+    {
+        std::atomic_ref<uint8_t>(*reinterpret_cast<uint8_t*>(m_data + ringCleanOffset)).store(1, std::memory_order_release);
+        #ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        #else
+        ::munmap(m_data, m_size);
+        #endif
+    }
+    #ifdef _WIN32
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    #endif
+}
+
+void Log::FlightRecorder::write(Log::Type logType, const Log::Timestamp& time, const std::string& message)
+{
+    thread_local std::string line;
+    line.clear();
+    appendBytes(line, (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time.wall.time_since_epoch()).count());
+    appendBytes(line, (int64_t)time.monotonic.count());
+    appendBytes(line, (int8_t)logType);
+    line += message;
+
+    const uint64_t slots = std::max<uint64_t>((line.size() + ringSlotDataSize - 1) / ringSlotDataSize, 1);
+    const uint64_t first = std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(m_data + ringNextOffset)).fetch_add(slots, std::memory_order_relaxed);
+
+    for (uint64_t i = 0; i < slots; i++)
+    {
+        const uint64_t sequence = first + i;
+        char* slot = m_data + ringHeaderSize + (sequence % m_slotCount) * ringSlotSize;
+        std::atomic_ref<uint64_t> slotSequence(*reinterpret_cast<uint64_t*>(slot));
+        // marking the slot as empty first so a crash while writing it does not leave half of a line that looks valid
+        slotSequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const size_t offset = i * ringSlotDataSize;
+        const uint16_t size = (uint16_t)std::min(line.size() - std::min(offset, line.size()), ringSlotDataSize);
+        const uint8_t flags = (i == 0 ? ringFirstSlot : 0) | (i == slots - 1 ? ringLastSlot : 0);
+        std::memcpy(slot + ringSlotSizeFieldOffset, &size, sizeof(size));
+        slot[ringSlotFlagsOffset] = (char)flags;
+        std::memcpy(slot + ringSlotDataOffset, line.data() + offset, size);
+        slotSequence.store(sequence, std::memory_order_release);
+    }
+}
 
 bool Log::printToCout = false;
 std::string Log::LogFolder = "Logs";
 std::ofstream Log::file;
+std::string Log::filePath;
+std::ofstream Log::binaryFile;
+std::string Log::binaryFilePath;
+std::vector<bool> Log::writtenFormats;
+
+/// @brief gives back the preallocated space of the current files when the program exits
+class Log::FileCloser
+{
+public:
+    ~FileCloser()
+    {
+        std::lock_guard<std::mutex> guard(fileLock);
+        Log::closeFiles(true);
+        Log::saveIndex();
+    }
+};
+// destroyed after the async writer is drained but before the files
+Log::FileCloser Log::fileCloser;
 
 Log::Log()
 {
-    // per day
-    constexpr const int maxLogs = 10000;
+    std::lock_guard<std::mutex> guard(fileLock);
+    Log::prepareFile();
+}
+
+void Log::scanFolder()
+{
+    std::error_code error;
+    std::filesystem::create_directories(Log::LogFolder, error);
 
-    if (!std::filesystem::exists(Log::LogFolder))
+    // the sizes are only needed for the folder limit and getting them is most of the time taken
+    const bool getSizes = segments.maxFolderSize != 0;
+    const bool isOpen = Log::file.is_open();
+    segments.oldFiles.clear();
+    segments.oldFilesSize = 0;
+    if (!isOpen)
     {
-        std::filesystem::create_directory(Log::LogFolder);
+        segments.date = Log::getCurrentDate();
+        segments.index = 0;
     }
 
-    std::string currentDate = Log::getCurrentDate();
-    std::string fileName = Log::LogFolder + "/" + currentDate + ".log";
-    for (int i = 0; i < maxLogs; ++i)
+    // the old logs oldest first, the sizes are only known if getting sizes or loaded from the index
+    const std::filesystem::path folder = std::filesystem::path(Log::LogFolder).lexically_normal();
+    std::vector<std::pair<std::string, uintmax_t>> files;
+    bool sized = true;
+    if (!loadIndex(folder, files))
     {
-        if (std::filesystem::exists(fileName))
+        files.clear();
+        sized = getSizes;
+        // one pass over the folder instead of checking if each possible file name exists
+        std::vector<std::tuple<std::filesystem::file_time_type, std::string, uintmax_t>> found;
+        for (const std::filesystem::directory_entry& entry: std::filesystem::directory_iterator(folder, error))
         {
-            fileName = Log::LogFolder + "/" + currentDate + "-" + std::to_string(i) + ".log";
+            const std::string extension = entry.path().extension().string();
+            if ((extension != ".log" && extension != ".blog") || !entry.is_regular_file(error))
+                continue;
+            if (getSizes)
+                found.emplace_back(entry.last_write_time(error), entry.path().string(), entry.file_size(error));
+            else
+                found.emplace_back(std::filesystem::file_time_type(), entry.path().string(), 0);
         }
-        else
+        std::sort(found.begin(), found.end());
+        files.reserve(found.size());
+        for (auto& [time, path, size]: found)
+            files.emplace_back(std::move(path), size);
+    }
+
+    // compared as normalized paths so the folder can be given with a trailing slash
+    const std::filesystem::path textPath = std::filesystem::path(Log::filePath).lexically_normal();
+    const std::filesystem::path binaryPath = std::filesystem::path(Log::binaryFilePath).lexically_normal();
+    for (auto& [path, size]: files)
+    {
+        const std::filesystem::path filePath(path);
+        if (isOpen && (filePath == textPath || filePath == binaryPath))
+            continue;
+
+        // every launch starts a new file so the index is after the last file from today
+        const std::string stem = filePath.stem().string();
+        if (!isOpen)
         {
-            break;
+            if (stem == segments.date)
+                segments.index = std::max<size_t>(segments.index, 1);
+            else if (stem.size() > segments.date.size() + 1 && stem.starts_with(segments.date) && stem[segments.date.size()] == '-')
+            {
+                const std::string number = stem.substr(segments.date.size() + 1);
+                if (number.find_first_not_of("0123456789") == std::string::npos)
+                    segments.index = std::max<size_t>(segments.index, std::stoull(number) + 2);
+            }
+        }
+
+        if (sized)
+        {
+            segments.oldFilesSize += size;
+            segments.oldFiles.emplace_back(std::move(path), size);
         }
     }
+    segments.scanned = true;
+    segments.sized = sized;
+}
+
+void Log::saveIndex()
+{
+    // only the sizes of every old log make the index useful
+    if (!segments.scanned || !segments.sized)
+        return;
 
-    Log::file.open(fileName, std::ios::out | std::ios::app);
+    // written in place (not replaced) so the folders time only changes the first time it is made
+    std::ofstream file(std::filesystem::path(Log::LogFolder) / indexFileName, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return;
+    file << indexHeader << '\n';
+    for (const auto& [path, size]: segments.oldFiles)
+        file << size << ' ' << std::filesystem::path(path).filename().string() << '\n';
+}
+
+void Log::openFile()
+{
+    if (!segments.scanned)
+        Log::scanFolder();
+
+    Log::filePath = segmentPath(Log::LogFolder, segments.date, segments.index, ".log");
+    segments.textPreallocated = preallocate(Log::filePath, segments.maxFileSize);
+    Log::file.open(Log::filePath, std::ios::out | std::ios::app);
     if (!Log::file.is_open())
     {
-        std::cerr << "Error opening log file: " << Log::LogFolder << std::endl;
+        std::cerr << "Error opening log file: " << Log::filePath << std::endl;
     }
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(Log::filePath, error);
+    segments.textSize = error ? 0 : size;
+}
+
+void Log::openBinaryFile()
+{
+    if (!Log::file.is_open())
+        Log::openFile();
+
+    Log::binaryFilePath = std::filesystem::path(Log::filePath).replace_extension(".blog").string();
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(Log::binaryFilePath, error);
+    segments.binaryPreallocated = preallocate(Log::binaryFilePath, segments.maxFileSize);
+    segments.binarySize = error ? 0 : size;
+
+    Log::binaryFile.open(Log::binaryFilePath, std::ios::out | std::ios::app | std::ios::binary);
+    if (!Log::binaryFile.is_open())
+        std::cerr << "Error opening binary log file: " << Log::binaryFilePath << std::endl;
+    else if (segments.binarySize == 0)
+    {
+        Log::binaryFile.write(binaryMagic, sizeof(binaryMagic));
+        segments.binarySize += sizeof(binaryMagic);
+    }
+    // ids are only valid for this run so every format is written again in each file
+    Log::writtenFormats.clear();
+}
+
+void Log::closeFiles(bool keep)
+{
+    auto close = [keep](std::ofstream& file, const std::string& path, uintmax_t size, uintmax_t preallocated){
+        if (!file.is_open())
+            return;
+        file.close();
+        releasePreallocation(path, preallocated);
+        if (keep)
+        {
+            segments.oldFiles.emplace_back(path, size);
+            segments.oldFilesSize += size;
+        }
+    };
+    close(Log::file, Log::filePath, segments.textSize, segments.textPreallocated);
+    close(Log::binaryFile, Log::binaryFilePath, segments.binarySize, segments.binaryPreallocated);
+    segments.textSize = segments.binarySize = 0;
+    segments.textPreallocated = segments.binaryPreallocated = 0;
+}
+
+void Log::prepareFile()
+{
+    if (!Log::file.is_open())
+        Log::openFile();
+    else if (segments.maxFileSize != 0 && segments.textSize + segments.binarySize >= segments.maxFileSize)
+    {
+        Log::closeFiles(true);
+        const std::string date = Log::getCurrentDate();
+        if (date != segments.date)
+        {
+            segments.date = date;
+            segments.index = 0;
+        }
+        else
+            segments.index++;
+        Log::openFile();
+    }
+
+    // the current files are never removed even if they are over the limit on there own
+    while (segments.maxFolderSize != 0 && !segments.oldFiles.empty() && 
+           segments.oldFilesSize + segments.textSize + segments.binarySize > segments.maxFolderSize)
+    {
+        std::error_code error;
+        std::filesystem::remove(segments.oldFiles.front().first, error);
+        segments.oldFilesSize -= segments.oldFiles.front().second;
+        segments.oldFiles.pop_front();
+    }
+}
+
+void Log::setLogFolder(std::string path)
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    // logs after this go to a new file in the new folder, old logs are not moved
+    const bool wasOpen = Log::file.is_open();
+    Log::closeFiles(true);
+    Log::saveIndex();
+    Log::LogFolder = std::move(path);
+    segments.scanned = false;
+    if (wasOpen)
+        Log::prepareFile();
+}
+
+std::string Log::getLogFolder()
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    return Log::LogFolder;
+}
+
+void Log::setMaxFileSize(uintmax_t bytes)
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    segments.maxFileSize = bytes;
+    if (Log::file.is_open())
+        Log::prepareFile();
+}
+
+uintmax_t Log::getMaxFileSize()
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    return segments.maxFileSize;
+}
+
+void Log::setMaxFolderSize(uintmax_t bytes)
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    segments.maxFolderSize = bytes;
+    if (bytes != 0 && segments.scanned && !segments.sized)
+        Log::scanFolder();
+    if (segments.scanned)
+        Log::prepareFile();
+}
+
+uintmax_t Log::getMaxFolderSize()
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    return segments.maxFolderSize;
 }
 
 const std::map<const Log::Type, const std::string> Log::LogDictionary = {
@@ -46,10 +861,13 @@ const std::map<const Log::Type, const std::string> Log::LogDictionary = {
     {Log::Type::Info, "Info"},
     {Log::Type::Warning, "Warning"},
     {Log::Type::Fatal, "Fatal"} };
+// defined after the other statics so it is destroyed (and drained) before anything it uses
+std::unique_ptr<Log::AsyncWriter> Log::asyncWriter;
+std::unique_ptr<Log::FlightRecorder> Log::flightRecorder;
 
 void Log::setPrintToCout(bool printToCout)
 {
-    printToCout = printToCout;
+    Log::printToCout = printToCout;
 }
 
 bool Log::getPrintToCout()
@@ -57,19 +875,473 @@ bool Log::getPrintToCout()
     return printToCout;
 }
 
+void Log::setPrintMicroseconds(bool printMicroseconds)
+{
+    Log::printMicroseconds.store(printMicroseconds, std::memory_order_relaxed);
+}
+
+bool Log::getPrintMicroseconds()
+{
+    return Log::printMicroseconds.load(std::memory_order_relaxed);
+}
+
+void Log::setPrintMonotonicTime(bool printMonotonicTime)
+{
+    Log::printMonotonicTime.store(printMonotonicTime, std::memory_order_relaxed);
+}
+
+bool Log::getPrintMonotonicTime()
+{
+    return Log::printMonotonicTime.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds Log::getMonotonicTime()
+{
+    return Log::now().monotonic;
+}
+
+std::string Log::getFilePath()
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    return Log::filePath;
+}
+
 void Log::add(Log::Type logType, std::string message)
 {
+    if (!Log::isEnabled(logType))
+        return;
+
+    const Timestamp time = Log::now();
+    // the ring has the log even if the program crashes before it gets to the file
+    if (Log::flightRecorder != nullptr)
+        Log::flightRecorder->write(logType, time, message);
+
+    if (Log::asyncWriter != nullptr)
+    {
+        Log::asyncWriter->push(logType, std::move(message));
+        return;
+    }
+
+    // formatting before taking the lock so threads only wait on each other for the write itself
+    std::string line;
+    Log::formatLine(line, logType, time, message);
+
+    std::lock_guard<std::mutex> guard(fileLock);
+    Log::prepareFile();
+    assert(Log::file.is_open() && "Log file failed to open, no logs will be saved");
+    Log::write(line);
+}
+
+void Log::setFlightRecorder(bool enabled, size_t size)
+{
+    Log::flightRecorder.reset();
+    if (!enabled)
+        return;
+
+    std::lock_guard<std::mutex> guard(fileLock);
+    Log::prepareFile();
+    const std::string path = Log::LogFolder + "/FlightRecorder.ring";
+
+    // the logs in the ring are also in the log file unless the program did not exit cleanly, then the newest ones could be missing from it
+    // so the ring is only added to the log file before it is remade if it was not closed
+    std::ifstream input(path, std::ios::in | std::ios::binary);
+    if (input.is_open())
+    {
+        std::stringstream recovered;
+        input.seekg(ringCleanOffset);
+        const bool clean = input.get() == 1;
+        input.clear();
+        input.seekg(0);
+        if (!clean && Log::recoverFlightRecorder(input, recovered) && recovered.tellp() > 0)
+        {
+            std::string lines;
+            Log::formatLine(lines, Log::Type::Info, Log::now(), "Logs recovered from the flight recorder (the program did not exit cleanly, some could already be above):");
+            lines += recovered.str();
+            Log::formatLine(lines, Log::Type::Info, Log::now(), "End of the recovered logs");
+            Log::write(lines);
+        }
+        input.close();
+    }
+
+    Log::flightRecorder = std::make_unique<FlightRecorder>(path, size);
+    if (!Log::flightRecorder->isOpen())
+    {
+        std::cerr << "Error opening the flight recorder file: " << path << std::endl;
+        Log::flightRecorder.reset();
+    }
+}
+
+bool Log::isFlightRecorder()
+{
+    return Log::flightRecorder != nullptr;
+}
+
+std::string Log::getFlightRecorderPath()
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    return Log::LogFolder + "/FlightRecorder.ring";
+}
+
+bool Log::recoverFlightRecorder(std::istream& input, std::ostream& output)
+{
+    const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (data.size() < ringHeaderSize || std::memcmp(data.data(), ringMagic, sizeof(ringMagic)) != 0)
+        return false;
+    uint32_t slotSize, slotCount;
+    std::memcpy(&slotSize, data.data() + ringSlotSizeOffset, sizeof(slotSize));
+    std::memcpy(&slotCount, data.data() + ringSlotCountOffset, sizeof(slotCount));
+    if (slotSize != ringSlotSize || slotCount == 0 || data.size() < ringHeaderSize + (size_t)slotCount * slotSize)
+        return false;
+
+    // the slots are in ring order so sorting by sequence puts the oldest first
+    std::vector<std::pair<uint64_t, const char*>> slots;
+    slots.reserve(slotCount);
+    for (size_t i = 0; i < slotCount; i++)
+    {
+        const char* slot = data.data() + ringHeaderSize + i * slotSize;
+        uint64_t sequence;
+        std::memcpy(&sequence, slot, sizeof(sequence));
+        // empty, being written, or not from this position
+        if (sequence == 0 || sequence % slotCount != i)
+            continue;
+        slots.emplace_back(sequence, slot);
+    }
+    std::sort(slots.begin(), slots.end());
+
+    // logs are only written if every slot of them is still there
+    std::string line;
+    std::string text;
+    uint64_t expected = 0;
+    bool inLine = false;
+    for (const auto& [sequence, slot]: slots)
+    {
+        uint16_t size;
+        std::memcpy(&size, slot + ringSlotSizeFieldOffset, sizeof(size));
+        const uint8_t flags = (uint8_t)slot[ringSlotFlagsOffset];
+        if (flags & ringFirstSlot)
+        {
+            line.clear();
+            inLine = true;
+        }
+        else if (!inLine || sequence != expected)
+        {
+            inLine = false;
+            continue;
+        }
+        line.append(slot + ringSlotDataOffset, std::min<size_t>(size, ringSlotDataSize));
+        expected = sequence + 1;
+        if (flags & ringLastSlot)
+        {
+            inLine = false;
+            int64_t wall, monotonic;
+            int8_t type;
+            constexpr size_t headerSize = sizeof(wall) + sizeof(monotonic) + sizeof(type);
+            if (line.size() < headerSize)
+                continue;
+            std::memcpy(&wall, line.data(), sizeof(wall));
+            std::memcpy(&monotonic, line.data() + sizeof(wall), sizeof(monotonic));
+            std::memcpy(&type, line.data() + sizeof(wall) + sizeof(monotonic), sizeof(type));
+            if (type < (int8_t)Log::Type::Error || type > (int8_t)Log::Type::Fatal)
+                continue;
+            text.clear();
+            const std::chrono::system_clock::time_point wallTime(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(wall)));
+            Log::formatLine(text, (Log::Type)type, {wallTime, std::chrono::nanoseconds(monotonic)}, line.substr(headerSize));
+            output << text;
+        }
+    }
+    return true;
+}
+
+void Log::setMinLevel(Log::Type logType)
+{
+    Log::minSeverity.store(Log::getSeverity(logType), std::memory_order_relaxed);
+}
+
+Log::Type Log::getMinLevel()
+{
+    switch (Log::minSeverity.load(std::memory_order_relaxed))
+    {
+    case 0: return Log::Type::Debug;
+    case 1: return Log::Type::Info;
+    case 2: return Log::Type::Warning;
+    case 3: return Log::Type::Error;
+    default: return Log::Type::Fatal;
+    }
+}
+
+void Log::setAsync(bool async, size_t bufferSize, OverflowPolicy policy)
+{
+    // destroying the writer writes everything it still has
+    Log::asyncWriter.reset();
+    if (!async)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(fileLock);
+        Log::prepareFile();
+    }
     assert(Log::file.is_open() && "Log file failed to open, no logs will be saved");
+    Log::asyncWriter = std::make_unique<AsyncWriter>(bufferSize, policy);
+}
+
+bool Log::isAsync()
+{
+    return Log::asyncWriter != nullptr;
+}
+
+void Log::flush()
+{
+    if (Log::asyncWriter != nullptr)
+    {
+        Log::asyncWriter->flush();
+        return;
+    }
+    std::lock_guard<std::mutex> guard(fileLock);
+    Log::file.flush();
+}
+
+size_t Log::getDroppedCount()
+{
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+Log::FormatID Log::registerFormat(Log::Type logType, std::string format)
+{
+    std::lock_guard<std::mutex> guard(formatLock);
+    formats.emplace_back(logType, std::move(format));
+    return (FormatID)formats.size();
+}
+
+void Log::addEncoded(FormatID format, std::string&& args)
+{
+    assert(format != 0 && "Binary logs need a registered format");
+    if (Log::asyncWriter != nullptr)
+    {
+        // the type is stored with the format
+        Log::asyncWriter->push(Log::Type::Debug, std::move(args), format);
+        return;
+    }
+
+    const auto time = Log::now().wall;
+    std::string data;
+    std::lock_guard<std::mutex> guard(fileLock);
+    Log::prepareFile();
+    Log::appendBinary(data, format, time, args);
+    Log::writeBinary(data);
+}
+
+std::string Log::getBinaryFilePath()
+{
+    std::lock_guard<std::mutex> guard(fileLock);
+    return Log::binaryFilePath;
+}
 
-    auto now = std::chrono::system_clock::now();
- 
-    std::time_t time = std::chrono::system_clock::to_time_t(now);
+void Log::appendBinary(std::string& data, FormatID format, std::chrono::system_clock::time_point time, const std::string& args)
+{
+    // opening before checking the written formats since opening resets them
+    if (!Log::binaryFile.is_open())
+        Log::openBinaryFile();
+
+    if (format >= Log::writtenFormats.size())
+        Log::writtenFormats.resize(format + 1, false);
+    if (!Log::writtenFormats[format])
+    {
+        std::lock_guard<std::mutex> guard(formatLock);
+        const auto& [type, string] = formats[format - 1];
+        data += formatTag;
+        appendBytes(data, format);
+        appendBytes(data, (int8_t)type);
+        appendBytes(data, (uint32_t)string.size());
+        data += string;
+        Log::writtenFormats[format] = true;
+    }
+
+    data += logTag;
+    appendBytes(data, format);
+    appendBytes(data, (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    appendBytes(data, (uint32_t)args.size());
+    data += args;
+}
+
+void Log::writeBinary(const std::string& data)
+{
+    Log::binaryFile.write(data.data(), data.size());
+    Log::binaryFile.flush();
+    segments.binarySize += data.size();
+}
+
+bool Log::decodeBinary(std::istream& input, std::ostream& output)
+{
+    char magic[sizeof(binaryMagic)];
+    if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, binaryMagic, sizeof(magic)) != 0)
+        return false;
 
-    std::string temp = std::ctime(&time);
-    temp.erase(temp.begin() + temp.size()-1);
+    std::map<FormatID, std::pair<Log::Type, std::string>> decodedFormats;
+    std::string line;
+    std::string message;
+    char tag;
+    while (input.get(tag))
+    {
+        FormatID id;
+        uint32_t size;
+        if (tag == formatTag)
+        {
+            int8_t type;
+            if (!readBytes(input, id) || !readBytes(input, type) || !readBytes(input, size))
+                return false;
+            std::string format(size, '\0');
+            if (!input.read(format.data(), size))
+                return false;
+            // the same id can be used by a different format if the file was appended to by another run
+            decodedFormats[id] = {Log::Type(type), std::move(format)};
+            continue;
+        }
+        if (tag != logTag)
+            return false;
+
+        int64_t time;
+        if (!readBytes(input, id) || !readBytes(input, time) || !readBytes(input, size))
+            return false;
+        std::string args(size, '\0');
+        if (!input.read(args.data(), size))
+            return false;
+        auto format = decodedFormats.find(id);
+        if (format == decodedFormats.end())
+            return false;
+
+        // converting the arguments back to the strings they would have been
+        std::vector<std::string> strings;
+        for (size_t pos = 0; pos < args.size();)
+        {
+            const ArgType type = ArgType(args[pos++]);
+            auto read = [&]<typename T>(T value) -> T {
+                std::memcpy(&value, args.data() + pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            };
+            // making sure the argument is not cut off before reading it
+            const size_t argSize = (type == ArgType::Int8 || type == ArgType::UInt8 || type == ArgType::Bool || type == ArgType::Char) ? 1 :
+                                   (type == ArgType::Int16 || type == ArgType::UInt16) ? 2 :
+                                   (type == ArgType::Int32 || type == ArgType::UInt32 || type == ArgType::Float || type == ArgType::String) ? 4 : 8;
+            if (pos + argSize > args.size())
+                return false;
 
-    Log::file << '[' << temp << "] [" << Log::LogDictionary.find(logType)->second << "] -- " << message << std::endl;
+            switch (type)
+            {
+            case ArgType::Int8: strings.emplace_back(std::to_string(read(int8_t()))); break;
+            case ArgType::Int16: strings.emplace_back(std::to_string(read(int16_t()))); break;
+            case ArgType::Int32: strings.emplace_back(std::to_string(read(int32_t()))); break;
+            case ArgType::Int64: strings.emplace_back(std::to_string(read(int64_t()))); break;
+            case ArgType::UInt8: strings.emplace_back(std::to_string(read(uint8_t()))); break;
+            case ArgType::UInt16: strings.emplace_back(std::to_string(read(uint16_t()))); break;
+            case ArgType::UInt32: strings.emplace_back(std::to_string(read(uint32_t()))); break;
+            case ArgType::UInt64: strings.emplace_back(std::to_string(read(uint64_t()))); break;
+            case ArgType::Float: strings.emplace_back(std::to_string(read(float()))); break;
+            case ArgType::Double: strings.emplace_back(std::to_string(read(double()))); break;
+            case ArgType::Bool: strings.emplace_back(read(bool()) ? "true" : "false"); break;
+            case ArgType::Char: strings.emplace_back(1, read(char())); break;
+            case ArgType::String:
+            {
+                const uint32_t length = read(uint32_t());
+                if (pos + length > args.size())
+                    return false;
+                strings.emplace_back(args, pos, length);
+                pos += length;
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+
+        // replacing every "{}" with the next argument, extra arguments are added to the end
+        const std::string& formatString = format->second.second;
+        message.clear();
+        size_t nextArg = 0;
+        for (size_t i = 0; i < formatString.size(); i++)
+        {
+            if (formatString[i] == '{' && i + 1 < formatString.size() && formatString[i + 1] == '}' && nextArg < strings.size())
+            {
+                message += strings[nextArg++];
+                i++;
+            }
+            else
+                message += formatString[i];
+        }
+        for (; nextArg < strings.size(); nextArg++)
+        {
+            message += ' ';
+            message += strings[nextArg];
+        }
+
+        line.clear();
+        const std::chrono::system_clock::time_point wall(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time)));
+        Log::formatLine(line, format->second.first, {wall, std::chrono::nanoseconds(-1)}, message);
+        output << line;
+    }
+    return true;
+}
+
+Log::Timestamp Log::now()
+{
+    const int64_t monotonic = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    // keeping the wall clock in line with changes to the system time, threads doing this at the same time is fine since they get the same offset
+    if (monotonic >= nextWallSync.load(std::memory_order_relaxed))
+    {
+        const int64_t wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        wallOffset.store(wall - monotonic, std::memory_order_relaxed);
+        nextWallSync.store(monotonic + 1'000'000'000, std::memory_order_relaxed);
+    }
+    const std::chrono::nanoseconds wall(monotonic + wallOffset.load(std::memory_order_relaxed));
+    return {std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(wall)), std::chrono::nanoseconds(monotonic)};
+}
+
+void Log::formatLine(std::string& line, Log::Type logType, const Timestamp& time, const std::string& message)
+{
+    const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(time.wall.time_since_epoch()).count();
+    // rounding down for times before the epoch
+    const int64_t second = nanoseconds / 1'000'000'000 - (nanoseconds % 1'000'000'000 < 0);
+    TimeCache& cache = timeCache;
+    if (second != cache.second)
+    {
+        // same format as std::ctime but without its shared buffer so it can be called from any thread
+        const std::tm localTime = toLocalTime((std::time_t)second);
+        cache.prefixSize = std::strftime(cache.prefix, sizeof(cache.prefix), "%a %b %e %H:%M:%S", &localTime);
+        cache.suffixSize = std::strftime(cache.suffix, sizeof(cache.suffix), " %Y", &localTime);
+        cache.second = second;
+    }
+
+    line += '[';
+    line.append(cache.prefix, cache.prefixSize);
+    if (Log::printMicroseconds.load(std::memory_order_relaxed))
+    {
+        line += '.';
+        appendDigits(line, (uint64_t)(nanoseconds - second * 1'000'000'000) / 1000, 6);
+    }
+    line.append(cache.suffix, cache.suffixSize);
+    line += ']';
+    if (Log::printMonotonicTime.load(std::memory_order_relaxed) && time.monotonic.count() >= 0)
+    {
+        line += " [+";
+        appendDigits(line, (uint64_t)time.monotonic.count() / 1'000'000'000, 1);
+        line += '.';
+        appendDigits(line, (uint64_t)time.monotonic.count() % 1'000'000'000, 9);
+        line += ']';
+    }
+    line += " [";
+    line += Log::LogDictionary.find(logType)->second;
+    line += "] -- ";
+    line += message;
+    line += '\n';
+}
+
+void Log::write(const std::string& lines)
+{
+    Log::file.write(lines.data(), lines.size());
     Log::file.flush();
+    segments.textSize += lines.size();
+    if (Log::printToCout)
+        std::cout << lines << std::flush;
 }
 
 std::string Log::getCurrentTime()
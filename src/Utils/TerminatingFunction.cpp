@@ -38,26 +38,30 @@ bool TerminatingFunction::Data::isStopRequested() const
 
 bool TerminatingFunction::_tFunc::operator== (const _tFunc& tFunc) const
 {
-    return m_func.getTypeid() == tFunc.m_func.getTypeid();
+    return m_func.getID() == tFunc.m_func.getID();
 }
 
-bool TerminatingFunction::_tFunc::operator== (const std::string& id) const
+bool TerminatingFunction::_tFunc::operator== (funcHelper::funcID id) const
 {
-    return m_func.getTypeid() == id;
+    return m_func.getID() == id;
 }
 
 bool TerminatingFunction::_tFunc::operator< (const _tFunc& tFunc) const
 {
-    return m_func.getTypeid() < tFunc.m_func.getTypeid();
+    return m_func.getID() < tFunc.m_func.getID();
 }
 
-bool TerminatingFunction::_tFunc::operator< (const std::string& id) const
+bool TerminatingFunction::_tFunc::operator< (funcHelper::funcID id) const
 {
-    return m_func.getTypeid() < id;
+    return m_func.getID() < id;
 }
 
 std::string TerminatingFunction::_tFunc::getShortenedID(const std::string& typeID)
 {
+    // dynamic functions are bound in "bindDynamic" and normal functions in "setFunction"
+    const size_t start = typeID.find("bindDynamic");
+    if (start != std::string::npos)
+        return typeID.substr(start+11);
     return typeID.substr(typeID.find("setFunction")+11);
 }
 
@@ -104,44 +108,48 @@ void TerminatingFunction::UpdateFunctions(float deltaTime)
     m_lock.unlock();
 }
 
-std::string TerminatingFunction::Add(funcHelper::funcDynamic<Data*> function, float maxTime)
+funcHelper::funcID TerminatingFunction::Add(funcHelper::funcDynamic<Data*> function, float maxTime)
 { 
     m_lock.lock();
     if (function.isValid())
     {
-        TerminatingFunction::m_terminatingFunctions.emplace_back(function, maxTime); 
+        const funcHelper::funcID id = function.getID();
+        TerminatingFunction::m_terminatingFunctions.emplace_back(std::move(function), maxTime); 
         
         m_lock.unlock();
-        return function.getTypeid();
+        return id;
     }
     m_lock.unlock();
-    return "";
+    return funcHelper::INVALID_FUNC_ID;
 }
 
 void TerminatingFunction::clear()
 { 
     m_lock.lock(); 
-    for (auto function: m_terminatingFunctions)
+    for (auto& function: m_terminatingFunctions)
     {
         function.m_maxTime = -1.f;
     }
-    UpdateFunctions(0);
+    // UpdateFunctions takes the lock itself
     m_lock.unlock(); 
+    UpdateFunctions(0);
 }
 
-void TerminatingFunction::remove(const std::string& functionTypeid)
+void TerminatingFunction::remove(funcHelper::funcID functionID)
 {
     m_lock.lock();
-    auto iter = std::find(m_terminatingFunctions.begin(), m_terminatingFunctions.end(), functionTypeid);
-    if (iter != m_terminatingFunctions.end())
-        iter->m_maxTime = 0.f;
+    for (_tFunc& function: m_terminatingFunctions)
+    {
+        if (function == functionID)
+            function.m_maxTime = 0.f;
+    }
     m_lock.unlock();
 }
 
-void TerminatingFunction::forceRemove(const std::string& functionTypeid)
+void TerminatingFunction::forceRemove(funcHelper::funcID functionID)
 {
     m_lock.lock();
-    auto temp = std::remove(m_terminatingFunctions.begin(), m_terminatingFunctions.end(), functionTypeid); 
+    m_terminatingFunctions.remove_if([functionID](const _tFunc& function){ return function == functionID; });
     m_lock.unlock();
 }
 
@@ -150,7 +158,7 @@ std::list<std::list<std::string>> TerminatingFunction::getStringData()
     m_lock.lock();
     std::list<std::list<std::string>> rtn;
 
-    for (auto func: m_terminatingFunctions)
+    for (auto& func: m_terminatingFunctions)
     {
         rtn.push_back(func.toString());
     }
@@ -159,10 +167,10 @@ std::list<std::list<std::string>> TerminatingFunction::getStringData()
     return rtn;
 }
 
-bool TerminatingFunction::requestStop(const std::string& functionTypeid)
+bool TerminatingFunction::requestStop(funcHelper::funcID functionID)
 {
     m_lock.lock();
-    auto iter = std::find(m_terminatingFunctions.begin(), m_terminatingFunctions.end(), functionTypeid);
+    auto iter = std::find(m_terminatingFunctions.begin(), m_terminatingFunctions.end(), functionID);
     if (iter != m_terminatingFunctions.end())
     {
         iter->m_requestStop = true;
@@ -0,0 +1,202 @@
+#include "Utils/ThreadPool.hpp"
+
+#include <chrono>
+
+thread_local ThreadPool* ThreadPool::m_currentPool = nullptr;
+thread_local size_t ThreadPool::m_currentIndex = 0;
+
+namespace
+{
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief sets the given value to the max of it and the given value
+template <typename T>
+void storeMax(std::atomic<T>& value, T newValue)
+{
+    T current = value.load(std::memory_order_relaxed);
+    while (current < newValue && !value.compare_exchange_weak(current, newValue, std::memory_order_relaxed));
+}
+
+/// @brief the thread count the shared pool is created with
+std::atomic<size_t> sharedThreadCount = 0;
+std::atomic<bool> sharedCreated = false;
+}
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0)
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1;
+
+    for (size_t i = 0; i < threads; i++)
+        m_queues.emplace_back(std::make_unique<WorkQueue>());
+    // all queues have to exist before any worker starts stealing
+    for (size_t i = 0; i < threads; i++)
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_sleepLock);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker: m_workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::getShared()
+{
+    static ThreadPool pool([]{
+        sharedCreated = true;
+        return sharedThreadCount.load();
+    }());
+    return pool;
+}
+
+bool ThreadPool::setSharedThreadCount(size_t threads)
+{
+    if (sharedCreated)
+        return false;
+    sharedThreadCount = threads;
+    return true;
+}
+
+void ThreadPool::submit(Task&& task)
+{
+    const size_t queue = (m_currentPool == this) ? m_currentIndex : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    // counting the task before it can be popped, otherwise a pop could decrement the count first and wrap it
+    storeMax(m_maxDepth, m_queuedTasks.fetch_add(1, std::memory_order_release) + 1);
+    {
+        std::lock_guard<std::mutex> guard(m_queues[queue]->lock);
+        m_queues[queue]->tasks.push_back({std::move(task), now()});
+    }
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+
+    // taking the lock so a worker that just saw no tasks is either already waiting or will see this one
+    bool waiters;
+    {
+        std::lock_guard<std::mutex> guard(m_sleepLock);
+        waiters = m_waiting > 0;
+    }
+    m_wake.notify_one();
+    // threads in waitUntil could be the only ones that can run this task
+    if (waiters)
+        m_waiterWake.notify_all();
+}
+
+void ThreadPool::notifyWaiters()
+{
+    bool waiters;
+    {
+        std::lock_guard<std::mutex> guard(m_sleepLock);
+        waiters = m_waiting > 0;
+    }
+    if (waiters)
+        m_waiterWake.notify_all();
+}
+
+bool ThreadPool::runPendingTask()
+{
+    QueuedTask task;
+    const bool isWorker = (m_currentPool == this);
+    if ((isWorker && popTask(m_currentIndex, task)) || stealTask(isWorker ? m_currentIndex : m_queues.size(), task))
+    {
+        runTask(task);
+        return true;
+    }
+    return false;
+}
+
+ThreadPool::Stats ThreadPool::getStats() const
+{
+    Stats stats;
+    stats.depth = m_queuedTasks.load(std::memory_order_relaxed);
+    stats.maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+    stats.submitted = m_submitted.load(std::memory_order_relaxed);
+    stats.started = m_started.load(std::memory_order_relaxed);
+    stats.averageLatency = stats.started == 0 ? 0 : double(m_totalLatency.load(std::memory_order_relaxed)) / stats.started;
+    stats.maxLatency = m_maxLatency.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ThreadPool::resetStats()
+{
+    // the depth is the current state of the pool so it is kept
+    m_maxDepth = m_queuedTasks.load(std::memory_order_relaxed);
+    m_submitted = 0;
+    m_started = 0;
+    m_totalLatency = 0;
+    m_maxLatency = 0;
+}
+
+void ThreadPool::runTask(QueuedTask& task)
+{
+    const uint64_t latency = now() - task.queuedTime;
+    m_started.fetch_add(1, std::memory_order_relaxed);
+    m_totalLatency.fetch_add(latency, std::memory_order_relaxed);
+    storeMax(m_maxLatency, latency);
+    task.task();
+}
+
+bool ThreadPool::popTask(size_t queue, QueuedTask& task)
+{
+    WorkQueue& workQueue = *m_queues[queue];
+    std::lock_guard<std::mutex> guard(workQueue.lock);
+    if (workQueue.tasks.empty())
+        return false;
+
+    task = std::move(workQueue.tasks.back());
+    workQueue.tasks.pop_back();
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ThreadPool::stealTask(size_t thief, QueuedTask& task)
+{
+    // starting after the thief so workers dont all steal from the same queue
+    const size_t count = m_queues.size();
+    for (size_t offset = 1; offset <= count; offset++)
+    {
+        const size_t queue = (thief + offset) % count;
+        if (queue == thief)
+            continue;
+
+        WorkQueue& workQueue = *m_queues[queue];
+        std::lock_guard<std::mutex> guard(workQueue.lock);
+        if (workQueue.tasks.empty())
+            continue;
+
+        task = std::move(workQueue.tasks.front());
+        workQueue.tasks.pop_front();
+        m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    m_currentPool = this;
+    m_currentIndex = index;
+
+    while (true)
+    {
+        QueuedTask task;
+        if (popTask(index, task) || stealTask(index, task))
+        {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepLock);
+        m_wake.wait(lock, [this]{ return m_stopping || m_queuedTasks.load(std::memory_order_acquire) > 0; });
+        // finishing every queued task before stopping
+        if (m_stopping && m_queuedTasks.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
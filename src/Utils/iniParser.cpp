@@ -1,60 +1,547 @@
 #include "Utils/iniParser.hpp"
 #include "Utils/StringHelper.hpp"
 #include <cassert>
+#include <algorithm>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//* iniParser::MappedFile defs
+
+class iniParser::MappedFile
+{
+public:
+    MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline bool isOpen() const { return m_open; }
+    inline std::string_view getText() const { return {m_data, m_size}; }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_open = false;
+    #ifdef _WIN32
+    /// @brief a mapped file can not be replaced on windows so it is read into one buffer instead
+    std::unique_ptr<char[]> m_buffer;
+    #endif
+};
+
+iniParser::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    #ifdef _WIN32
+    std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
+    if (!file.is_open())
+        return;
+    m_size = (size_t)file.tellg();
+    m_buffer = std::make_unique<char[]>(m_size);
+    file.seekg(0);
+    file.read(m_buffer.get(), m_size);
+    m_data = m_buffer.get();
+    m_open = true;
+    #else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    struct stat info;
+    if (::fstat(fd, &info) == 0)
+    {
+        m_size = (size_t)info.st_size;
+        m_open = true;
+        if (m_size != 0)
+        {
+            int flags = MAP_PRIVATE;
+            #ifdef MAP_POPULATE
+            // the whole file is read when parsing so faulting it in at once is faster
+            flags |= MAP_POPULATE;
+            #endif
+            void* data = ::mmap(nullptr, m_size, PROT_READ, flags, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                m_size = 0;
+                m_open = false;
+            }
+            else
+                m_data = static_cast<const char*>(data);
+        }
+    }
+    // the mapping keeps the file open
+    ::close(fd);
+    #endif
+}
+
+iniParser::MappedFile::~MappedFile()
+{
+    #ifndef _WIN32
+    if (m_data != nullptr)
+        ::munmap(const_cast<char*>(m_data), m_size);
+    #endif
+}
+
+namespace
+{
+std::string_view trim(std::string_view string)
+{
+    const size_t first = string.find_first_not_of(" \t\n\r\f\v");
+    if (first == std::string_view::npos)
+        return {};
+    return string.substr(first, string.find_last_not_of(" \t\n\r\f\v") - first + 1);
+}
+
+/// @brief up to this many keys are searched in order since that is faster than hashing
+constexpr size_t maxUnindexed = 8;
+}
+
+//* iniParser::HashIndex defs
+
+template <typename KeyAt>
+uint32_t iniParser::HashIndex::find(std::string_view key, size_t hash, const KeyAt& keyAt) const
+{
+    if (m_slots.empty())
+        return npos;
+
+    const size_t mask = m_slots.size() - 1;
+    const uint32_t shortHash = (uint32_t)hash;
+    for (size_t i = shortHash & mask; m_slots[i].position != npos; i = (i + 1) & mask)
+    {
+        if (m_slots[i].hash == shortHash && keyAt(m_slots[i].position) == key)
+            return m_slots[i].position;
+    }
+    return npos;
+}
+
+void iniParser::HashIndex::insert(size_t hash, uint32_t position)
+{
+    // keeping at least half the slots empty so probes stay short
+    if ((m_size + 1) * 2 > m_slots.size())
+        this->reserve((m_size + 1) * 2);
+
+    const size_t mask = m_slots.size() - 1;
+    size_t i = (uint32_t)hash & mask;
+    while (m_slots[i].position != npos)
+        i = (i + 1) & mask;
+    m_slots[i] = {(uint32_t)hash, position};
+    m_size++;
+}
+
+void iniParser::HashIndex::erase(size_t hash, uint32_t position)
+{
+    if (m_slots.empty())
+        return;
+
+    const size_t mask = m_slots.size() - 1;
+    size_t i = (uint32_t)hash & mask;
+    while (m_slots[i].position != position)
+    {
+        if (m_slots[i].position == npos)
+            return;
+        i = (i + 1) & mask;
+    }
+
+    // shifting the following slots back into the hole so a probe never stops before reaching its key
+    for (size_t j = (i + 1) & mask; m_slots[j].position != npos; j = (j + 1) & mask)
+    {
+        const size_t home = m_slots[j].hash & mask;
+        // the slot can only be moved if the hole is not before where it would first be looked for
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+    }
+    m_slots[i] = Slot{};
+    m_size--;
+}
+
+void iniParser::HashIndex::clear()
+{
+    m_slots = {};
+    m_size = 0;
+}
+
+void iniParser::HashIndex::reserve(size_t count)
+{
+    size_t capacity = 16;
+    while (capacity < count * 2)
+        capacity *= 2;
+    if (capacity <= m_slots.size())
+        return;
+
+    std::vector<Slot> old(capacity);
+    old.swap(m_slots);
+    m_size = 0;
+    for (const Slot& slot: old)
+    {
+        if (slot.position != npos)
+            this->insert(slot.hash, slot.position);
+    }
+}
+
+//* iniParser::OrderedIndex defs
+
+template <typename Map>
+typename iniParser::OrderedIndex<Map>::Entry* iniParser::OrderedIndex<Map>::find(std::string_view key) const
+{
+    const uint32_t position = this->position(key);
+    return position == HashIndex::npos ? nullptr : m_order[position];
+}
+
+template <typename Map>
+uint32_t iniParser::OrderedIndex<Map>::position(std::string_view key) const
+{
+    if (!m_indexed)
+    {
+        for (uint32_t i = 0; i < m_order.size(); i++)
+        {
+            if (m_order[i] != nullptr && m_order[i]->first == key)
+                return i;
+        }
+        return HashIndex::npos;
+    }
+    return m_index.find(key, HashIndex::hash(key), [this](uint32_t position){ return std::string_view(m_order[position]->first); });
+}
+
+template <typename Map>
+void iniParser::OrderedIndex<Map>::add(Entry& entry)
+{
+    m_order.push_back(&entry);
+    if (m_indexed)
+        m_index.insert(HashIndex::hash(entry.first), (uint32_t)(m_order.size() - 1));
+    else if (m_order.size() - m_removed > maxUnindexed)
+        this->buildIndex();
+}
+
+template <typename Map>
+void iniParser::OrderedIndex<Map>::remove(uint32_t position)
+{
+    if (m_indexed)
+        m_index.erase(HashIndex::hash(m_order[position]->first), position);
+    m_order[position] = nullptr;
+    m_removed++;
+
+    // compacting once most of the order is removed entries, this moves positions so the index is rebuilt
+    if (m_removed > maxUnindexed && m_removed * 2 > m_order.size())
+    {
+        m_order.erase(std::remove(m_order.begin(), m_order.end(), nullptr), m_order.end());
+        m_removed = 0;
+        this->buildIndex();
+    }
+}
+
+template <typename Map>
+void iniParser::OrderedIndex<Map>::rename(uint32_t position, size_t oldHash)
+{
+    if (!m_indexed)
+        return;
+    m_index.erase(oldHash, position);
+    m_index.insert(HashIndex::hash(m_order[position]->first), position);
+}
+
+template <typename Map>
+void iniParser::OrderedIndex<Map>::clear()
+{
+    m_order = {};
+    m_removed = 0;
+    m_index.clear();
+    m_indexed = false;
+    m_valid = true;
+}
+
+template <typename Map>
+template <typename Function>
+void iniParser::OrderedIndex<Map>::forEach(const Function& function) const
+{
+    for (Entry* entry: m_order)
+    {
+        if (entry != nullptr)
+            function(*entry);
+    }
+}
+
+template <typename Map>
+void iniParser::OrderedIndex<Map>::copyOrder(const OrderedIndex& other, Map& map)
+{
+    m_order.clear();
+    m_order.reserve(map.size());
+    m_removed = 0;
+    m_valid = true;
+    other.forEach([&](const Entry& entry){
+        auto iterator = map.find(entry.first);
+        if (iterator != map.end())
+            m_order.push_back(&*iterator);
+    });
+    this->buildIndex();
+}
+
+template <typename Map>
+void iniParser::OrderedIndex<Map>::rebuild(Map& map)
+{
+    std::unordered_set<const Entry*> entries;
+    entries.reserve(map.size());
+    for (auto& entry: map)
+        entries.insert(&entry);
+
+    std::vector<Entry*> order;
+    order.reserve(map.size());
+    // the old entries could have been erased so they are only compared and never read
+    for (Entry* entry: m_order)
+    {
+        if (entry != nullptr && entries.erase(entry) != 0)
+            order.push_back(entry);
+    }
+    for (auto& entry: map)
+    {
+        if (entries.count(&entry) != 0)
+            order.push_back(&entry);
+    }
+
+    m_order = std::move(order);
+    m_removed = 0;
+    m_valid = true;
+    this->buildIndex();
+}
+
+template <typename Map>
+void iniParser::OrderedIndex<Map>::buildIndex()
+{
+    m_index.clear();
+    m_indexed = m_order.size() - m_removed > maxUnindexed;
+    if (!m_indexed)
+        return;
+
+    m_index.reserve(m_order.size() - m_removed);
+    for (uint32_t i = 0; i < m_order.size(); i++)
+    {
+        if (m_order[i] != nullptr)
+            m_index.insert(HashIndex::hash(m_order[i]->first), i);
+    }
+}
 
 //* iniParser::SectionData defs
 
-std::string* iniParser::SectionData::getValue(const std::string& key)
+iniParser::SectionData::SectionData(const SectionData& other) : 
+    m_data(other.m_data), m_views(other.m_views), m_viewIndex(other.m_viewIndex), m_source(other.m_source)
 {
-    auto interator = m_data.find(key);
-    if (interator == m_data.end())
-        return nullptr;
+    other.m_keys.sync(other.m_data);
+    m_keys.copyOrder(other.m_keys, m_data);
+}
 
-    return &(interator->second);
+iniParser::SectionData& iniParser::SectionData::operator=(const SectionData& other)
+{
+    if (this != &other)
+        *this = SectionData(other);
+    return *this;
+}
+
+std::pair<const std::string, std::string>* iniParser::SectionData::find(std::string_view key) const
+{
+    m_keys.sync(m_data);
+    return m_keys.find(key);
+}
+
+std::pair<const std::string, std::string>& iniParser::SectionData::add(std::string_view key, std::string value) const
+{
+    auto& entry = *m_data.emplace(std::string(key), std::move(value)).first;
+    m_keys.add(entry);
+    return entry;
 }
 
-const std::string* iniParser::SectionData::getValue(const std::string& key) const
+uint32_t iniParser::SectionData::findView(std::string_view key, size_t hash) const
 {
-    auto interator = m_data.find(key);
-    if (interator == m_data.end())
+    if (m_viewIndex.size() == 0)
+    {
+        for (uint32_t i = 0; i < m_views.size(); i++)
+        {
+            if (m_views[i].first == key)
+                return i;
+        }
+        return HashIndex::npos;
+    }
+    return m_viewIndex.find(key, hash, [this](uint32_t position){ return m_views[position].first; });
+}
+
+bool iniParser::SectionData::addView(std::string_view key, std::string_view value)
+{
+    const size_t hash = HashIndex::hash(key);
+    // the first of any duplicate keys is kept (same as the owned data)
+    if (this->findView(key, hash) != HashIndex::npos)
+        return false;
+
+    m_views.emplace_back(key, value);
+    if (m_viewIndex.size() != 0)
+        m_viewIndex.insert(hash, (uint32_t)(m_views.size() - 1));
+    else if (m_views.size() > maxUnindexed)
+    {
+        m_viewIndex.reserve(m_views.size());
+        for (uint32_t i = 0; i < m_views.size(); i++)
+            m_viewIndex.insert(HashIndex::hash(m_views[i].first), i);
+    }
+    return true;
+}
+
+std::string* iniParser::SectionData::getValue(std::string_view key)
+{
+    this->copyMapped();
+    auto entry = this->find(key);
+    if (entry == nullptr)
         return nullptr;
+    // the value could be changed through the pointer
+    this->changed(entry->second);
+    return &entry->second;
+}
 
-    return &(interator->second);
+const std::string* iniParser::SectionData::getValue(std::string_view key) const
+{
+    this->copyMapped();
+    auto entry = this->find(key);
+    return entry == nullptr ? nullptr : &entry->second;
 }
 
-std::string& iniParser::SectionData::operator[](const std::string& key)
+std::string& iniParser::SectionData::operator[](std::string_view key)
 { 
-    auto interator = m_data.find(key);
-    if (interator == m_data.end())
-        return m_data.insert({key, ""}).first->second;
+    this->copyMapped();
+    if (auto entry = this->find(key))
+    {
+        this->changed(entry->second);
+        return entry->second;
+    }
+    m_keysChanged = true;
+    // new values are tracked too since they could be changed through the returned reference after a save
+    auto& value = this->add(key, "").second;
+    this->changed(value);
+    return value;
+}
+
+std::pair<std::string&, bool> iniParser::SectionData::insert(std::string_view key, const std::string& value)
+{
+    this->copyMapped();
+    if (auto entry = this->find(key))
+    {
+        // the value could be changed through the returned reference
+        this->changed(entry->second);
+        return {entry->second, false};
+    }
+    m_keysChanged = true;
+    auto& added = this->add(key, value).second;
+    this->changed(added);
+    return {added, true};
+}
 
-    return interator->second;
+std::string& iniParser::SectionData::setValue(std::string_view key, const std::string& value)
+{
+    this->copyMapped();
+    if (auto entry = this->find(key))
+    {
+        this->changed(entry->second);
+        entry->second = value;
+        return entry->second;
+    }
+    m_keysChanged = true;
+    auto& added = this->add(key, value).second;
+    this->changed(added);
+    return added;
 }
 
-std::pair<std::string*, bool> iniParser::SectionData::changeKey(const std::string& originalKey, const std::string& newKey)
+std::pair<std::string*, bool> iniParser::SectionData::changeKey(std::string_view originalKey, std::string_view newKey)
 {
-    auto originalIter = m_data.find(originalKey);
-    auto newIter = m_data.find(newKey);
-    if (originalIter == m_data.end())
+    this->copyMapped();
+    m_keys.sync(m_data);
+    const uint32_t position = m_keys.position(originalKey);
+    if (position == HashIndex::npos)
         return {nullptr, false};
-    else if (newIter != m_data.end())
-        return {&originalIter->second, false};
+    auto entry = m_keys.at(position);
+    // the value could be changed through the returned pointer (renaming keeps the node so the value does not move)
+    this->changed(entry->second);
+    if (m_keys.find(newKey) != nullptr)
+        return {&entry->second, false};
 
-    std::string temp = originalIter->second;
-    m_data.erase(originalIter);
-    auto iter = m_data.emplace(newKey, temp);
-    return {&iter.first->second, true};
+    const size_t oldHash = HashIndex::hash(originalKey);
+    // putting the same node back with the new key so the value is not copied and the entry keeps its place
+    auto node = m_data.extract(m_data.find(entry->first));
+    node.key() = std::string(newKey);
+    m_data.insert(std::move(node));
+    m_keys.rename(position, oldHash);
+    m_keysChanged = true;
+    return {&entry->second, true};
 }
 
-bool iniParser::SectionData::remove(const std::string& key)
+std::optional<std::string_view> iniParser::SectionData::getView(std::string_view key) const
 {
-    auto iterator = m_data.find(key);
-    if (iterator == m_data.end())
+    if (m_source != nullptr)
+    {
+        const uint32_t position = this->findView(key, HashIndex::hash(key));
+        if (position == HashIndex::npos)
+            return std::nullopt;
+        return m_views[position].second;
+    }
+
+    auto entry = this->find(key);
+    if (entry == nullptr)
+        return std::nullopt;
+    return entry->second;
+}
+
+void iniParser::SectionData::copyViews() const
+{
+    m_keys.sync(m_data);
+    for (const auto& [key, value]: m_views)
+        this->add(key, std::string(value));
+    m_views.clear();
+    m_views.shrink_to_fit();
+    m_viewIndex.clear();
+    m_source.reset();
+    // the cached values where keyed by the views
+    m_cache.clear();
+}
+
+bool iniParser::SectionData::remove(std::string_view key)
+{
+    this->copyMapped();
+    m_keys.sync(m_data);
+    const uint32_t position = m_keys.position(key);
+    if (position == HashIndex::npos)
         return false;
+    auto iterator = m_data.find(m_keys.at(position)->first);
+    this->uncache(iterator->second);
+    m_savedValues.erase(&iterator->second);
+    m_keys.remove(position);
     m_data.erase(iterator);
+    m_keysChanged = true;
     return true;
 }
 
+bool iniParser::SectionData::isChanged(const std::string& value) const
+{
+    auto saved = m_savedValues.find(&value);
+    return saved != m_savedValues.end() && saved->second != value;
+}
+
+bool iniParser::SectionData::isChanged() const
+{
+    if (m_keysChanged)
+        return true;
+    for (const auto& [value, saved]: m_savedValues)
+    {
+        if (*value != saved)
+            return true;
+    }
+    return false;
+}
+
+void iniParser::SectionData::markSaved()
+{
+    m_keysChanged = false;
+    for (auto& [value, saved]: m_savedValues)
+        saved = *value;
+}
+
 //* iniParser defs
 
 iniParser::iniParser(const std::string& generic_path)
@@ -101,6 +588,10 @@ bool iniParser::isOpen() const
 void iniParser::setData(const std::map<std::string, SectionData>& Data)
 {
     this->m_data = Data;
+    // the new sections are saved in map order
+    m_sections.clear();
+    m_sections.invalidate();
+    m_layoutKnown = false;
 }
 
 void iniParser::closeFile(bool ignoreAutosave)
@@ -110,97 +601,156 @@ void iniParser::closeFile(bool ignoreAutosave)
         this->save();
     }
     m_file.close();
+    m_layoutKnown = false;
 }
 
 void iniParser::clearData()
 {
     m_data.clear();
+    m_sections.clear();
+    m_layout.clear();
+    m_layoutKnown = false;
     this->clearFormatErrors();
 }
 
 bool iniParser::parseData(bool ignoreDuplicateSections)
+{
+    return this->parse(ignoreDuplicateSections, false);
+}
+
+bool iniParser::parseMapped(bool ignoreDuplicateSections)
+{
+    return this->parse(ignoreDuplicateSections, true);
+}
+
+bool iniParser::parse(bool ignoreDuplicateSections, bool mapped)
 {
     // clearing any old data
     this->clearData();
+    if (!this->isOpen())
+        return false;
+
+    // reading the whole file at once and only looking at it through views so nothing is copied until it is added
+    auto file = std::make_shared<const MappedFile>(this->m_filePath);
+    if (!file->isOpen())
+        return false;
+    const std::string_view text = file->getText();
 
-    // Current Line
-    std::string curLine;
-    
     bool gettingSectionData = false;
-    std::string currentSectionName = "";
-    SectionData currentSectionData;
+    std::string_view currentSectionName = "";
+    SectionData currentSection;
+    size_t sectionStart = 0;
+    // the size the section would be saved as, if it matches the size in the file then the file has nothing extra in the section
+    size_t sectionSize = 0;
+    // true if some of the file is not part of any added section (dropped duplicate sections or keys before the first section)
+    bool skippedText = false;
+
+    /// @param sectionEnd where the last line of the section ends (not including the new line)
+    auto addSection = [&](size_t sectionEnd){
+        std::string_view name = currentSectionName;
+        std::string renamed;
+        if (!ignoreDuplicateSections)
+        {
+            int i = 0;
+            while (this->find(name) != nullptr)
+            {
+                renamed = std::string(currentSectionName) + '(' + std::to_string(++i) + ')';
+                name = renamed;
+                m_formatErrors.duplicateSections = true;
+            }
+        }
 
-    while (std::getline(this->m_file, curLine))
+        // if the section already exists the first one is kept
+        if (this->find(name) == nullptr)
+        {
+            if (mapped)
+                currentSection.m_source = file;
+            else
+                currentSection.m_keys.buildIndex();
+            currentSection.m_keysChanged = false;
+            auto& entry = this->add(name, std::move(currentSection));
+            const size_t size = sectionEnd - sectionStart;
+            m_layout.push_back({&entry, sectionStart, size, name.size() + 2 + sectionSize == size});
+        }
+        else
+            skippedText = true;
+        currentSection = SectionData();
+        sectionSize = 0;
+    };
+
+    size_t lineStart = 0;
+    while (lineStart < text.size())
     {
-        StringHelper::trim(curLine);
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
+        std::string_view curLine = trim(text.substr(lineStart, lineEnd - lineStart));
+        const size_t lineOffset = lineStart;
+        lineStart = lineEnd + 1;
 
+        if (curLine.empty())
+            continue;
         // this line is a section name
-        if (curLine[0] == '[')
+        else if (curLine[0] == '[')
         {
             // if we finished finding section data add it to map before starting next section
             if (gettingSectionData)
-            {
-                this->m_data.insert({currentSectionName, currentSectionData});
-                currentSectionData.removeAll();
-            }
-            
+                addSection(lineOffset == 0 ? 0 : lineOffset - 1);
+
             // ignore comment
-            auto commentAt = curLine.find_first_of(';');
-            if (commentAt != std::string::npos)
-            {
-                curLine = curLine.substr(0, commentAt);
-            }
+            curLine = curLine.substr(0, curLine.find(';'));
             // find name of section
             auto closingBracketAt = curLine.find_last_of(']');
-            if (closingBracketAt != std::string::npos)
-            {
-                currentSectionName = curLine.substr(1, closingBracketAt - 1);
-                StringHelper::trim(currentSectionName);
-            }
-            // if no closing bracket then faulty formatting
-            else
+            if (closingBracketAt == std::string_view::npos)
             {
                 // faulty formatted section
                 m_formatErrors.section = true;
                 continue;
             }
-
+            currentSectionName = trim(curLine.substr(1, closingBracketAt - 1));
+            sectionStart = lineOffset;
             gettingSectionData = true;
         }
         // this line is a key not a section name
-        else if (curLine != "")
+        else
         {
             size_t temp = curLine.find('=');
-            
-            if (temp == std::string::npos) 
+            if (temp == std::string_view::npos) 
             {
                 // faulty formatted line
                 m_formatErrors.key = true;
                 continue;
             }
 
-            // if data was there insert into map
-            currentSectionData.insert(curLine.substr(0, temp), curLine.substr(temp+1));
-        }
-    }
+            // keys before the first section are added to the first section but are not inside of its text
+            if (!gettingSectionData)
+                skippedText = true;
 
-    // adding the map into the data map if the section that was being made had not been added yet
-    if (currentSectionName != "") 
-    {
-        std::string temp = currentSectionName;
-        if (!ignoreDuplicateSections)
-        {
-            int i = 0;
-            while (m_data.find(temp) != m_data.end())
+            const std::string_view key = curLine.substr(0, temp);
+            bool added = true;
+            if (mapped)
+                added = currentSection.addView(key, curLine.substr(temp + 1));
+            else
             {
-                temp = currentSectionName + '(' + std::to_string(++i) + ')';
-                m_formatErrors.duplicateSections = true;
+                // the first of any duplicate keys is kept
+                auto [entry, emplaced] = currentSection.m_data.emplace(key, curLine.substr(temp + 1));
+                if (emplaced)
+                    currentSection.m_keys.append(*entry);
+                added = emplaced;
             }
+            if (added)
+                sectionSize += curLine.size() + 1;
         }
-        
-        this->m_data.emplace(temp, currentSectionData);
     }
 
+    // adding the section that was being made if it had not been added yet
+    if (gettingSectionData) 
+        addSection(text.size());
+
+    // the sections are only known to be where they where parsed from if nothing was skipped
+    m_layoutKnown = !skippedText && !this->hasFormatError();
+    this->recordFileState();
+
     if (this->m_data.size() == 0) 
     {
         // no data was loaded
@@ -243,40 +793,67 @@ void iniParser::createCopyError(const std::string path)
     std::filesystem::copy_file(this->m_filePath, tempPath);
 }
 
-iniParser::SectionData* iniParser::getSection(const std::string& section)
+std::pair<const std::string, iniParser::SectionData>* iniParser::find(std::string_view section) const
 {
-    auto iterator = m_data.find(section);
-    if (iterator == m_data.end())
-        return nullptr;
+    // only pointers to the sections are taken so the map is not changed here
+    m_sections.sync(const_cast<std::map<std::string, SectionData>&>(m_data));
+    return m_sections.find(section);
+}
 
-    return &(iterator->second);
+std::pair<const std::string, iniParser::SectionData>& iniParser::add(std::string_view section, SectionData&& sectionData)
+{
+    auto& entry = *m_data.emplace(std::string(section), std::move(sectionData)).first;
+    m_sections.add(entry);
+    m_layoutKnown = false;
+    return entry;
 }
 
-const iniParser::SectionData* iniParser::getSection(const std::string& section) const
+iniParser::SectionData* iniParser::getSection(std::string_view section)
 {
-    auto iterator = m_data.find(section);
-    if (iterator == m_data.end())
-        return nullptr;
+    auto entry = this->find(section);
+    return entry == nullptr ? nullptr : &entry->second;
+}
 
-    return &(iterator->second);
+const iniParser::SectionData* iniParser::getSection(std::string_view section) const
+{
+    auto entry = this->find(section);
+    return entry == nullptr ? nullptr : &entry->second;
 }
 
-iniParser::SectionData& iniParser::operator[](const std::string& section)
+iniParser::SectionData& iniParser::operator[](std::string_view section)
 { 
-    auto iterator = m_data.find(section);
-    if (iterator == m_data.end())
-        return m_data.insert({section, SectionData{}}).first->second;
+    if (auto entry = this->find(section))
+        return entry->second;
+    return this->add(section, SectionData()).second;
+}
 
-    return iterator->second;
+std::pair<iniParser::SectionData&, bool> iniParser::insertSection(std::string_view section, const SectionData& sectionData)
+{
+    if (auto entry = this->find(section))
+        return {entry->second, false};
+    return {this->add(section, SectionData(sectionData)).second, true};
 }
 
-bool iniParser::removeSection(const std::string& section)
+iniParser::SectionData& iniParser::setSection(std::string_view section, const SectionData& sectionData)
 {
-    auto iter = m_data.find(section);
-    if (iter == m_data.end())
-        return false;
+    if (auto entry = this->find(section))
+    {
+        entry->second = sectionData;
+        return entry->second;
+    }
+    return this->add(section, SectionData(sectionData)).second;
+}
 
-    m_data.erase(iter);
+bool iniParser::removeSection(std::string_view section)
+{
+    m_sections.sync(m_data);
+    const uint32_t position = m_sections.position(section);
+    if (position == HashIndex::npos)
+        return false;
+    auto iterator = m_data.find(m_sections.at(position)->first);
+    m_sections.remove(position);
+    m_data.erase(iterator);
+    m_layoutKnown = false;
     return true;
 }
 
@@ -286,28 +863,240 @@ void iniParser::setAutosave(bool Autosave)
 bool iniParser::isAutosave() const
 { return this->m_autosave; }
 
+void iniParser::setAutosaveDelay(std::chrono::milliseconds delay)
+{ 
+    this->m_autosaveDelay = delay; 
+    m_nextAutosave = std::chrono::steady_clock::now() + delay;
+}
+
+std::chrono::milliseconds iniParser::getAutosaveDelay() const
+{ return this->m_autosaveDelay; }
+
+void iniParser::update()
+{
+    if (!m_autosave || m_autosaveDelay.count() <= 0 || !this->isOpen())
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now < m_nextAutosave)
+        return;
+    m_nextAutosave = now + m_autosaveDelay;
+    if (this->isDirty())
+        this->save();
+}
+
+bool iniParser::isDirty() const
+{
+    if (!m_layoutKnown)
+        return true;
+    return std::any_of(m_layout.begin(), m_layout.end(), [](const SectionSpan& span){ return span.section->second.isChanged(); });
+}
+
 bool iniParser::save()
 {
-    if (this->isOpen() && m_data.size() > 0)
+    if (!this->isOpen() || m_data.size() == 0)
+        return false;
+
+    if (m_layoutKnown && this->saveChanges())
+        return true;
+    return this->saveAll();
+}
+
+void iniParser::appendSection(std::string& text, const std::pair<const std::string, SectionData>& section)
+{
+    text += '[';
+    text += section.first;
+    text += ']';
+    auto appendKey = [&text](std::string_view key, std::string_view value){
+        text += '\n';
+        text += key;
+        text += '=';
+        text += value;
+    };
+    if (section.second.isMapped())
     {
-        std::ofstream file(this->m_filePath, std::ios_base::binary);
-        if (!file.is_open()) return false;
+        for (const auto& [key, value]: section.second.m_views)
+            appendKey(key, value);
+    }
+    else
+    {
+        section.second.m_keys.sync(section.second.m_data);
+        section.second.m_keys.forEach([&](const std::pair<const std::string, std::string>& keyValue){ 
+            appendKey(keyValue.first, keyValue.second); 
+        });
+    }
+}
+
+namespace
+{
+/// @brief makes sure the file is on disk before it replaces anything
+void syncFile(const std::filesystem::path& path)
+{
+    #ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        ::fsync(fd);
+        ::close(fd);
+    }
+    #else
+    (void)path;
+    #endif
+}
+}
+
+bool iniParser::saveChanges()
+{
+    std::error_code error;
+    const uintmax_t fileSize = std::filesystem::file_size(m_filePath, error);
+    if (error || fileSize != m_fileSize)
+        return false;
+    const auto fileTime = std::filesystem::last_write_time(m_filePath, error);
+    if (error || fileTime != m_fileTime)
+        return false;
+
+    // every changed section has to fit exactly where it was or the whole file is written
+    std::vector<std::pair<uint64_t, std::string>> writes;
+    for (const SectionSpan& span: m_layout)
+    {
+        const SectionData& data = span.section->second;
+        if (!data.isChanged())
+            continue;
+        if (!span.canonical)
+            return false;
 
-        for (auto section = m_data.begin(); section != m_data.end(); section++)
+        if (data.m_keysChanged)
         {
-            if (section != this->m_data.begin()) file << "\n";
-            file << '[' << section->first << "]\n";
-            for (std::map<std::string, std::string>::const_iterator key = section->second.getData().begin(); key != section->second.getData().end(); key++)
+            std::string text;
+            appendSection(text, *span.section);
+            if (text.size() != span.size)
+                return false;
+            writes.emplace_back(span.offset, std::move(text));
+            continue;
+        }
+
+        // only values changed so only the keys from the first to the last changed value are written (the ones between could have moved)
+        data.m_keys.sync(data.m_data);
+        uint64_t offset = span.offset + span.section->first.size() + 2;
+        uint64_t first = UINT64_MAX;
+        uint64_t last = 0;
+        data.m_keys.forEach([&](const std::pair<const std::string, std::string>& keyValue){
+            const uint64_t start = offset;
+            offset += keyValue.first.size() + keyValue.second.size() + 2;
+            if (data.isChanged(keyValue.second))
             {
-                file << key->first << '=' << key->second;
-                if (key != (--section->second.getData().end())) file << "\n";
+                first = std::min(first, start);
+                last = offset;
             }
+        });
+        if (offset - span.offset != span.size)
+            return false;
+
+        std::string text;
+        offset = span.offset + span.section->first.size() + 2;
+        data.m_keys.forEach([&](const std::pair<const std::string, std::string>& keyValue){
+            if (offset >= first && offset < last)
+            {
+                text += '\n';
+                text += keyValue.first;
+                text += '=';
+                text += keyValue.second;
+            }
+            offset += keyValue.first.size() + keyValue.second.size() + 2;
+        });
+        writes.emplace_back(first, std::move(text));
+    }
+
+    if (!writes.empty())
+    {
+        std::fstream file(m_filePath, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        if (!file.is_open())
+            return false;
+        for (const auto& [offset, text]: writes)
+        {
+            file.seekp(offset);
+            file.write(text.data(), text.size());
         }
+        file.flush();
+        if (!file.good())
+            return false;
+        file.close();
+        syncFile(m_filePath);
+    }
 
-        this->m_file.clear();
-        return true;
+    for (const SectionSpan& span: m_layout)
+        span.section->second.markSaved();
+    this->recordFileState();
+    return true;
+}
+
+bool iniParser::saveAll()
+{
+    // the new file is only renamed over the old one once it is fully written so a crash can not leave a partly written file
+    // mapped sections point into the old file which stays readable until it is unmapped
+    std::filesystem::path path = this->m_filePath;
+    path += ".tmp";
+
+    std::vector<SectionSpan> layout;
+    {
+        std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+        if (!file.is_open()) return false;
+
+        m_sections.sync(m_data);
+        std::string text;
+        uint64_t written = 0;
+        m_sections.forEach([&](std::pair<const std::string, SectionData>& section){
+            if (written + text.size() != 0)
+                text += '\n';
+            const size_t start = text.size();
+            appendSection(text, section);
+            layout.push_back({&section, written + start, text.size() - start, true});
+            // writing in chunks so large files are not held in memory twice
+            if (text.size() >= 1024 * 1024)
+            {
+                file.write(text.data(), text.size());
+                written += text.size();
+                text.clear();
+            }
+        });
+        file.write(text.data(), text.size());
+        if (!file.good())
+        {
+            file.close();
+            std::filesystem::remove(path);
+            return false;
+        }
     }
-    return false;
+    syncFile(path);
+
+    std::error_code error;
+    // keeping the permissions of the file that is replaced
+    const auto status = std::filesystem::status(this->m_filePath, error);
+    if (!error)
+        std::filesystem::permissions(path, status.permissions(), error);
+    // the open file has to be closed first on windows
+    m_file.close();
+    std::filesystem::rename(path, this->m_filePath, error);
+    m_file.open(this->m_filePath, std::ios_base::binary);
+    if (error)
+    {
+        std::filesystem::remove(path, error);
+        return false;
+    }
+
+    m_layout = std::move(layout);
+    m_layoutKnown = true;
+    for (const SectionSpan& span: m_layout)
+        span.section->second.markSaved();
+    this->recordFileState();
+    return true;
+}
+
+void iniParser::recordFileState()
+{
+    std::error_code error;
+    m_fileSize = std::filesystem::file_size(m_filePath, error);
+    m_fileTime = std::filesystem::last_write_time(m_filePath, error);
 }
 
 void iniParser::createFile(const std::filesystem::path& filePath)
@@ -0,0 +1,51 @@
+#include "Utils/Log.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+
+// Converts binary logs (.blog) made with LOG_BINARY back into text logs, also recovers the logs in flight recorder files (.ring)
+// Usage: logDecoder <binary log or ring file> [output file], the text is printed to cout if no output file is given
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <binary log or ring file> [output file]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::in | std::ios::binary);
+    if (!input.is_open())
+    {
+        std::cerr << "Could not open: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if (argc > 2)
+    {
+        outputFile.open(argv[2], std::ios::out | std::ios::trunc);
+        if (!outputFile.is_open())
+        {
+            std::cerr << "Could not open: " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+
+    if (std::filesystem::path(argv[1]).extension() == ".ring")
+    {
+        if (!Log::recoverFlightRecorder(input, argc > 2 ? outputFile : std::cout))
+        {
+            std::cerr << "Not a flight recorder file" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!Log::decodeBinary(input, argc > 2 ? outputFile : std::cout))
+    {
+        std::cerr << "The binary log is invalid or cut off, everything before that was decoded" << std::endl;
+        return 1;
+    }
+    return 0;
+}